@@ -5,16 +5,19 @@
 #include <string>
 #include <thread>
 #include <memory>
+#include <optional>
 #include <CLI11.hpp>
 #include <iostream>
-#include <concurrentqueue/concurrentqueue.h>
 #include "binancehistoricaldatafetcher/binance_futures_orderbook.h"
 #include "binancehistoricaldatafetcher/binance_futures_book_builder.h"
 #include "binancehistoricaldatafetcher/binance_futures_orderbook_snapshots_socket_client.h"
 #include "binancehistoricaldatafetcher/binance_market_data_models.h"
 #include "binancehistoricaldatafetcher/orderbook_archiver.h"
 #include "common/io/questdb_writer.h"
+#include "common/reference/reference_data_service.h"
+#include "common/sync/bounded_queue.h"
 #include "common/sync/producer_consumer.h"
+#include "common/sync/wait_strategy.h"
 
 using namespace binance::models;
 using namespace common::models;
@@ -30,6 +33,16 @@ constexpr auto DEFAULT_WEBSOCKET_METHOD = "SUBSCRIBE";
 constexpr auto DEFAULT_SNAPSHOT_PARAMS_FORMAT = "@depth20@100ms";
 constexpr auto BTCUSDT_TICK_SIZE = 2;
 constexpr auto BTCUSDT_STEP_SIZE = 3;
+constexpr size_t DEFAULT_BATCH_SIZE = 64;
+constexpr auto DEFAULT_BATCH_TIMEOUT_MS = 100;
+constexpr auto DEFAULT_WAIT_STRATEGY = "park";
+// snapshots waiting for QuestDB, about 1.5 KB each at depth 20
+constexpr size_t DEFAULT_QUEUE_CAPACITY = 65536;
+constexpr auto DEFAULT_QUEUE_POLICY = "drop_oldest";
+// about 40 snapshots per flush, the latency bound covers quiet symbols
+constexpr size_t DEFAULT_SNAPSHOT_FLUSH_KB = 64;
+constexpr auto DEFAULT_FLUSH_LATENCY_MS = 1000;
+constexpr uint64_t DEFAULT_SPOOL_MAX_MB = 4096;
 
 std::vector<std::string> get_symbols(std::string syms) {
     std::vector<std::string> symbols;
@@ -59,6 +72,17 @@ struct config {
     size_t depth{};
     std::string questdb_url;
     BinanceFuturesOnOpenSocketMessage socket_open_msg;
+    std::optional<std::string> reference_data_path;
+    size_t batch_size{DEFAULT_BATCH_SIZE};
+    std::chrono::milliseconds batch_timeout{DEFAULT_BATCH_TIMEOUT_MS};
+    common::sync::WaitOptions wait;
+    size_t queue_capacity{DEFAULT_QUEUE_CAPACITY};
+    common::sync::OverflowPolicy queue_policy{common::sync::OverflowPolicy::DROP_OLDEST};
+    size_t flushes_in_flight{writer::DEFAULT_FLUSHES_IN_FLIGHT};
+    size_t questdb_connections{writer::DEFAULT_WRITER_CONNECTIONS};
+    common::io::FlushBudget flush_budget{.bytes = DEFAULT_SNAPSHOT_FLUSH_KB * 1024};
+    int flush_latency_ms{DEFAULT_FLUSH_LATENCY_MS};
+    std::optional<writer::SpoolOptions> spool;
 };
 
 config parse_command_line(int argc, char** argv) {
@@ -71,6 +95,48 @@ config parse_command_line(int argc, char** argv) {
     app.add_option("--depth", depth, "Order book depth to maintain")->default_val(std::to_string(DEFAULT_DEPTH));
     std::string questdb_url = DEFAULT_QUESTDB_URL;
     app.add_option("--questdb_url", questdb_url, "QuestDB HTTP URL")->default_val(DEFAULT_QUESTDB_URL);
+    std::string reference_data_path;
+    app.add_option("--reference_data", reference_data_path, "exchangeInfo JSON file with the symbol precisions");
+    size_t batch_size = DEFAULT_BATCH_SIZE;
+    app.add_option("--batch_size", batch_size, "Snapshots per bulk hand off to the writer")->default_val(std::to_string(DEFAULT_BATCH_SIZE));
+    int batch_timeout_ms = DEFAULT_BATCH_TIMEOUT_MS;
+    app.add_option("--batch_timeout_ms", batch_timeout_ms, "Longest a snapshot waits for its batch to fill")->default_val(std::to_string(DEFAULT_BATCH_TIMEOUT_MS));
+    std::string wait_strategy = DEFAULT_WAIT_STRATEGY;
+    app.add_option("--wait_strategy", wait_strategy, "How idle threads wait: spin, yield or park")
+        ->default_val(DEFAULT_WAIT_STRATEGY)
+        ->check(CLI::IsMember({"spin", "yield", "park"}));
+    size_t queue_capacity = DEFAULT_QUEUE_CAPACITY;
+    app.add_option("--queue_capacity", queue_capacity, "Snapshots allowed to wait for the writer")
+        ->default_val(std::to_string(DEFAULT_QUEUE_CAPACITY))
+        ->check(CLI::PositiveNumber);
+    std::string queue_policy = DEFAULT_QUEUE_POLICY;
+    app.add_option("--queue_policy", queue_policy, "What a full writer queue does: block the book builders, drop_oldest or drop_newest")
+        ->default_val(DEFAULT_QUEUE_POLICY)
+        ->check(CLI::IsMember({"block", "drop_oldest", "drop_newest"}));
+    size_t flushes_in_flight = writer::DEFAULT_FLUSHES_IN_FLIGHT;
+    app.add_option("--flushes_in_flight", flushes_in_flight, "Encoded buffers allowed to wait for or be in a QuestDB flush")
+        ->default_val(std::to_string(writer::DEFAULT_FLUSHES_IN_FLIGHT))
+        ->check(CLI::PositiveNumber);
+    size_t questdb_connections = writer::DEFAULT_WRITER_CONNECTIONS;
+    app.add_option("--questdb_connections", questdb_connections, "QuestDB connections the symbols are spread over")
+        ->default_val(std::to_string(writer::DEFAULT_WRITER_CONNECTIONS))
+        ->check(CLI::PositiveNumber);
+    size_t flush_kb = DEFAULT_SNAPSHOT_FLUSH_KB;
+    app.add_option("--flush_kb", flush_kb, "Encoded snapshots per QuestDB flush in KB")
+        ->default_val(std::to_string(DEFAULT_SNAPSHOT_FLUSH_KB))
+        ->check(CLI::PositiveNumber);
+    int flush_latency_ms = DEFAULT_FLUSH_LATENCY_MS;
+    app.add_option("--flush_latency_ms", flush_latency_ms, "Longest a snapshot waits in a buffer that has not reached --flush_kb")
+        ->default_val(std::to_string(DEFAULT_FLUSH_LATENCY_MS))
+        ->check(CLI::PositiveNumber);
+    bool auto_tune_flush = false;
+    app.add_flag("--auto_tune_flush", auto_tune_flush, "Move the flush size with the observed flush latency");
+    std::string spool_dir;
+    app.add_option("--spool_dir", spool_dir, "Directory snapshots are spooled to while QuestDB is unreachable, replayed in order once it is back (disabled if unset, needs an http connection string and the same --questdb_connections on every restart)");
+    uint64_t spool_max_mb = DEFAULT_SPOOL_MAX_MB;
+    app.add_option("--spool_max_mb", spool_max_mb, "Size limit of the spool in MB, snapshots that do not fit are dropped")
+        ->default_val(std::to_string(DEFAULT_SPOOL_MAX_MB))
+        ->check(CLI::PositiveNumber);
     app.parse(argc, argv);
     // add options here as needed
     config cfg;
@@ -79,16 +145,33 @@ config parse_command_line(int argc, char** argv) {
     cfg.depth = depth;
     cfg.questdb_url = questdb_url;
     cfg.socket_open_msg = build_on_open_message(cfg.symbols);
+    cfg.wait.policy = common::sync::getWaitPolicy(wait_strategy);
+    cfg.batch_size = batch_size;
+    cfg.batch_timeout = std::chrono::milliseconds{batch_timeout_ms};
+    cfg.queue_capacity = queue_capacity;
+    cfg.queue_policy = common::sync::getOverflowPolicy(queue_policy);
+    cfg.flushes_in_flight = flushes_in_flight;
+    cfg.questdb_connections = questdb_connections;
+    cfg.flush_budget.bytes = flush_kb * 1024;
+    cfg.flush_budget.autoTune = auto_tune_flush;
+    cfg.flush_latency_ms = flush_latency_ms;
+    if (!spool_dir.empty()) {
+        cfg.spool = writer::SpoolOptions{spool_dir, spool_max_mb * 1024 * 1024};
+    }
+    if (!reference_data_path.empty()) {
+        cfg.reference_data_path = reference_data_path;
+    }
     return cfg;
 }
 
-auto build_exchange_info_map() {
-    std::unordered_map<std::string, ExchangeInfo> exchange_info;
-    ExchangeInfo info{};
-    info.tick_size = BTCUSDT_TICK_SIZE;
-    info.step_size = BTCUSDT_STEP_SIZE;
-    exchange_info["btcusdt"] = info;
-    return exchange_info;
+// the exchangeInfo file covers any symbol, without one only the built in btcusdt precisions are known
+auto build_reference_data(const config& cfg) {
+    if (cfg.reference_data_path.has_value()) {
+        return common::reference::ReferenceDataService::from_file(cfg.reference_data_path.value(), cfg.symbols);
+    }
+    common::reference::ReferenceDataService reference_data;
+    reference_data.add("btcusdt", BTCUSDT_TICK_SIZE, BTCUSDT_STEP_SIZE);
+    return reference_data;
 }
 
 int build_and_start_snapshot_archiver(const config& cfg) {
@@ -100,35 +183,49 @@ int archiver_factory(const config& cfg) {
 }
 
 int main(const int argc, char** argv) {
-    auto [websocket_url, symbols, depth, questdb_url, socket_open_msg] = parse_command_line(argc, argv);
-    auto exchange_info = std::make_shared<std::unordered_map<std::string, ExchangeInfo>>(build_exchange_info_map());
+    const auto cfg = parse_command_line(argc, argv);
+    const auto& [websocket_url, symbols, depth, questdb_url, socket_open_msg, reference_data_path, batch_size, batch_timeout, wait,
+        queue_capacity, queue_policy, flushes_in_flight, questdb_connections, flush_budget, flush_latency_ms, spool] = cfg;
+    const auto reference_data = std::make_shared<const common::reference::ReferenceDataService>(build_reference_data(cfg));
     auto multi_symbol_orderbook = std::make_shared<BinanceFuturesOrderbook>(
-        symbols,
+        reference_data->ids(symbols),
         FUTURES,
-        exchange_info,
-        depth
+        reference_data,
+        depth,
+        wait
     );
-    auto data_events_queue = moodycamel::ConcurrentQueue<DataEvent>();
+    common::sync::BoundedQueue<DataEvent> data_events_queue(queue_capacity, queue_policy);
+    // the writer parks on dataReady and the book builders ring it, close() cancels the worker loop
+    const auto writer_context = std::make_shared<common::sync::producer_consumer::Context>();
     auto socket_client = std::make_unique<downloader::BinanceFuturesOrderbookSnapshotsSocketClient>(
         websocket_url,
         socket_open_msg,
         multi_symbol_orderbook->get_queues(),
-        exchange_info
+        reference_data
     );
     auto book_builder = std::make_unique<binance::processor::BinanceFuturesBookBuilder>(
         multi_symbol_orderbook,
         std::move(socket_client),
         data_events_queue,
-        depth
+        depth,
+        batch_size,
+        batch_timeout,
+        wait,
+        &writer_context->dataReady
     );
     auto questdb_writer = std::make_unique<writer::QuestDBWriter>(
         data_events_queue,
         questdb_url,
-        std::make_shared<common::sync::producer_consumer::Context>(), // Not ideal, but close will cancel the worker loop
-        exchange_info,
-        5,
-        1000,
-        SNAPSHOT
+        writer_context,
+        reference_data,
+        flush_budget,
+        flush_latency_ms,
+        SNAPSHOT,
+        nullptr,
+        wait,
+        flushes_in_flight,
+        questdb_connections,
+        spool
     );
     const auto archiver = std::make_unique<binance::processor::OrderbookArchiver>(
         std::move(book_builder),
@@ -141,8 +238,15 @@ int main(const int argc, char** argv) {
         return EXIT_FAILURE;
     }
 
-    while (binance::processor::OrderbookArchiver::runningFlag()) {
-        std::cout << "INFO::Running..." << "\n";
+    common::sync::QueueMeter queue_meter;
+    while (binance::processor::OrderbookArchiver::runningFlag() && !archiver->failed()) {
+        std::cout << "INFO::Running... queue " << queue_meter.sample(data_events_queue);
+        for (const auto &connection : archiver->connectionStats()) {
+            if (connection.spool.records > 0) {
+                std::cout << " spooled=" << connection.spool.records << " (" << connection.spool.bytes / 1024 << " KB)";
+            }
+        }
+        std::cout << "\n";
         std::this_thread::sleep_for(seconds(1));
     }
     if (const auto res = archiver->stop(); res != 0) {
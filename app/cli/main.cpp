@@ -7,25 +7,19 @@
 #include "binancehistoricaldatafetcher/constants.h"
 #include "binancehistoricaldatafetcher/HistoricalDataProcessor.h"
 #include "binancehistoricaldatafetcher/file_downloader.h"
+#include "common/io/job_manifest.h"
 #include "common/io/questdb_writer.h"
 #include "common/models/enums.h"
+#include "common/sync/bounded_queue.h"
 #include "common/sync/producer_consumer.h"
 #include "common/models/common_data_models.h"
+#include "common/reference/reference_data_service.h"
 
 // TODO - DEBUG - THIS WILL NOT RUN; LOGIC IS BROKEN - JUST FOR REFERENCE
 
 using namespace common::models;
 using namespace common::models::enums;
 
-auto build_exchange_info_map() {
-    std::unordered_map<std::string, ExchangeInfo> exchange_info;
-    ExchangeInfo info{};
-    info.tick_size = 3;
-    info.step_size = 4;
-    exchange_info["btcusdt"] = info;
-    return exchange_info;
-}
-
 int main(const int argc, char** argv) {
     CLI::App app{APP_NAME};
 
@@ -34,9 +28,9 @@ int main(const int argc, char** argv) {
     app.add_flag("--product", "Product type: futures, options, spot")
         ->required()
         ->check(CLI::IsMember({"futures", "options", "spot"}));
-    app.add_flag("--downloadType", "Download type: monthly, daily")
+    app.add_flag("--downloadType", "Download type: monthly, daily, auto (whole months monthly, edges daily)")
         ->required()
-        ->check(CLI::IsMember({"monthly", "daily"}));
+        ->check(CLI::IsMember({"monthly", "daily", "auto"}));
     app.add_flag("--outputType", "Output type: parquet, questdb")
         ->required()
         ->check(CLI::IsMember({"parquet", "questdb"}));
@@ -47,6 +41,62 @@ int main(const int argc, char** argv) {
     app.add_option("--symbols", "Comma-separated list of symbols")
         ->required();
     app.add_option("--dbURL", "Database URL for QuestDB output");
+    app.add_option("--parallelism", "Threads in the fetch stage (concurrent downloads)")
+        ->default_val(DEFAULT_PARALLELISM)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--parseThreads", "Threads parsing each archive, rows keep their file order")
+        ->default_val(DEFAULT_PARSE_THREADS)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--parseWorkers", "Threads in the parse stage, each inflates and parses one archive at a time")
+        ->default_val(DEFAULT_PARSE_WORKERS)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--prefetch", "Downloaded archives allowed to wait for the parse stage")
+        ->default_val(DEFAULT_PREFETCH_ARCHIVES)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--batchRows", "Rows per block handed from the parse stage to the writer")
+        ->default_val(downloader::DEFAULT_BATCH_ROWS)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--queueBlocks", "Row blocks allowed to wait for the writer, the parse stage blocks once they are queued")
+        ->default_val(DEFAULT_EVENT_QUEUE_BLOCKS)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--flushesInFlight", "Encoded row buffers allowed to wait for or be in a QuestDB flush while the writer encodes the next")
+        ->default_val(writer::DEFAULT_FLUSHES_IN_FLIGHT)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--writerConnections", "QuestDB connections the writer spreads symbols over, each keeps its symbols' rows in order")
+        ->default_val(writer::DEFAULT_WRITER_CONNECTIONS)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--flushKB", "Encoded rows per QuestDB flush in KB, a connection flushes once its buffer reaches it")
+        ->default_val(DEFAULT_FLUSH_KB)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--flushLatencyMs", "Longest rows wait in a buffer that has not reached --flushKB")
+        ->default_val(FLUSH_INTERVAL_MS)
+        ->check(CLI::PositiveNumber);
+    app.add_flag("--autoTuneFlush", "Grow or shrink the flush size from the observed flush latency to keep throughput near its peak");
+    app.add_option("--spoolDir", "Directory QuestDB batches are spooled to while the database is unreachable, replayed in order once it is back (disabled if unset, needs an http connection string and the same --writerConnections on every restart)");
+    app.add_option("--spoolMaxGB", "Size limit of the spool in GB, batches that do not fit are dropped")
+        ->default_val(DEFAULT_SPOOL_MAX_GB)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--waitStrategy", "How the writer waits for rows: spin (lowest latency, burns a core), yield, park (near zero idle CPU)")
+        ->default_val("park")
+        ->check(CLI::IsMember({"spin", "yield", "park"}));
+    app.add_flag("--dryRun", "Print the planned archives and the trimmed time window of each, then exit");
+    app.add_option("--manifest", "Job manifest file recording the progress of every archive, enables checkpointing");
+    app.add_flag("--resume", "Skip archives the manifest marks as flushed by a previous run (requires --manifest)");
+    app.add_flag("--stream", "Stream archives straight from HTTP into the parser without temporary files");
+    app.add_option("--referenceData", "exchangeInfo JSON file with the symbol precisions (fetched from Binance if unset)");
+    app.add_option("--cacheDir", "Directory for the persistent, checksum verified archive cache (disabled if unset)");
+    app.add_option("--cacheMaxGB", "Size limit of the archive cache in GB, least recently used archives are evicted first")
+        ->default_val(DEFAULT_CACHE_MAX_GB)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--maxRetries", "Attempts per file before giving up, interrupted transfers resume from the last byte received")
+        ->default_val(downloader::DEFAULT_MAX_ATTEMPTS)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--rangeSplitMB", "Archives larger than this are fetched over parallel byte ranges (0 disables)")
+        ->default_val(DEFAULT_RANGE_SPLIT_MB)
+        ->check(CLI::NonNegativeNumber);
+    app.add_option("--rangeConnections", "Parallel byte range connections per large archive")
+        ->default_val(downloader::DEFAULT_RANGE_CONNECTIONS)
+        ->check(CLI::PositiveNumber);
 
     try {
         app.parse(argc, argv);
@@ -57,6 +107,7 @@ int main(const int argc, char** argv) {
         auto product = getProduct(app.get_option("--product")->as<std::string>());
         const auto outputType = getOutputType(app.get_option("--outputType")->as<std::string>());
         auto symbols = app.get_option("--symbols")->as<std::vector<std::string>>();
+        const auto parallelism = app.get_option("--parallelism")->as<size_t>();
 
         if (outputType == QUESTDB) {
             settings.dbUrl = app.get_option("--dbURL")->as<std::string>();
@@ -71,29 +122,112 @@ int main(const int argc, char** argv) {
         settings.endDate = end;
         settings.symbols = symbols;
         settings.product = product;
-        settings.batchSize = BATCH_SIZE;
+        settings.parallelism = parallelism;
+        settings.parseThreads = app.get_option("--parseThreads")->as<size_t>();
+        settings.parseWorkers = app.get_option("--parseWorkers")->as<size_t>();
+        settings.prefetch = app.get_option("--prefetch")->as<size_t>();
+        settings.batchRows = app.get_option("--batchRows")->as<size_t>();
+        settings.queueBlocks = app.get_option("--queueBlocks")->as<size_t>();
+        settings.flushesInFlight = app.get_option("--flushesInFlight")->as<size_t>();
+        settings.writerConnections = app.get_option("--writerConnections")->as<size_t>();
+        settings.flushBytes = app.get_option("--flushKB")->as<size_t>() * 1024;
+        settings.flushLatencyMs = app.get_option("--flushLatencyMs")->as<int>();
+        settings.autoTuneFlush = app.count("--autoTuneFlush") > 0;
+        if (app.count("--spoolDir") > 0) {
+            settings.spoolDir = app.get_option("--spoolDir")->as<std::string>();
+        }
+        settings.spoolMaxBytes = app.get_option("--spoolMaxGB")->as<uint64_t>() * 1024 * 1024 * 1024;
+        settings.waitPolicy = common::sync::getWaitPolicy(app.get_option("--waitStrategy")->as<std::string>());
+        settings.streaming = app.count("--stream") > 0;
+        settings.dryRun = app.count("--dryRun") > 0;
+        if (app.count("--manifest") > 0) {
+            settings.manifestPath = app.get_option("--manifest")->as<std::string>();
+        }
+        settings.resume = app.count("--resume") > 0;
+        if (settings.resume && !settings.manifestPath.has_value()) {
+            std::cerr << "Error: --resume requires --manifest" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (app.count("--referenceData") > 0) {
+            settings.referenceDataPath = app.get_option("--referenceData")->as<std::string>();
+        }
+        if (app.count("--cacheDir") > 0) {
+            settings.cacheDir = app.get_option("--cacheDir")->as<std::string>();
+        }
+        settings.cacheMaxBytes = app.get_option("--cacheMaxGB")->as<uint64_t>() * 1024 * 1024 * 1024;
+        settings.maxAttempts = app.get_option("--maxRetries")->as<int>();
+        settings.rangeSplitBytes = app.get_option("--rangeSplitMB")->as<uint64_t>() * 1024 * 1024;
+        settings.rangeConnections = app.get_option("--rangeConnections")->as<size_t>();
+
+        // planning needs neither reference data nor the network
+        if (settings.dryRun) {
+            const auto units = downloader::plan_units(settings.symbols, settings.dataType, settings.downloadType, settings.startDate, settings.endDate);
+            size_t monthly = 0;
+            for (const auto &unit : units) {
+                monthly += unit.granularity == MONTHLY;
+                std::cout << unit.url << " [" << unit.from_ms << ", " << unit.to_ms << ")" << std::endl;
+            }
+            std::cout << units.size() << " archives (" << monthly << " monthly, " << units.size() - monthly << " daily)" << std::endl;
+            return EXIT_SUCCESS;
+        }
 
         auto context = std::make_shared<Context>();
 
-        auto buffer = moodycamel::ConcurrentQueue<DataEvent>(BUFFER_SIZE);
+        // never drops: a unit's completion marker must not overtake rows that were thrown away
+        common::sync::BoundedQueue<DataEvent> buffer(settings.queueBlocks, common::sync::OverflowPolicy::BLOCK);
+
+        std::shared_ptr<downloader::ArchiveCache> cache;
+        if (settings.cacheDir.has_value()) {
+            cache = std::make_shared<downloader::ArchiveCache>(settings.cacheDir.value(), settings.cacheMaxBytes);
+        }
+
+        std::shared_ptr<common::io::JobManifest> manifest;
+        if (settings.manifestPath.has_value()) {
+            manifest = std::make_shared<common::io::JobManifest>(settings.manifestPath.value(), settings.resume);
+        }
+
+        // symbol ids follow the order of --symbols
+        const auto reference_data = std::make_shared<const common::reference::ReferenceDataService>(
+            settings.referenceDataPath.has_value()
+                ? common::reference::ReferenceDataService::from_file(settings.referenceDataPath.value(), settings.symbols)
+                : common::reference::ReferenceDataService::from_url(common::reference::BINANCE_FUTURES_EXCHANGE_INFO_URL, settings.symbols)
+        );
 
         auto downloader = std::make_unique<downloader::FileDownloader>(
             settings.dataType,
             settings.product,
             settings.downloadType,
             buffer,
-            context
+            context,
+            reference_data,
+            settings.streaming,
+            cache,
+            downloader::HttpFetcherOptions{
+                .max_attempts = settings.maxAttempts,
+                .range_split_bytes = settings.rangeSplitBytes,
+                .range_connections = settings.rangeConnections
+            },
+            manifest,
+            settings.parseThreads,
+            settings.batchRows
         );
+
         auto dbURI = settings.dbUrl.value();
-        auto exchange_info = std::make_shared<std::unordered_map<std::string, ExchangeInfo>>();
         auto writer = std::make_unique<writer::QuestDBWriter>(
             buffer,
             dbURI,
             context,
-            exchange_info,
-            settings.batchSize,
-            FLUSH_INTERVAL_MS,
-            settings.dataType
+            reference_data,
+            common::io::FlushBudget{.bytes = settings.flushBytes, .autoTune = settings.autoTuneFlush},
+            settings.flushLatencyMs,
+            settings.dataType,
+            manifest,
+            common::sync::WaitOptions{.policy = settings.waitPolicy},
+            settings.flushesInFlight,
+            settings.writerConnections,
+            settings.spoolDir.has_value()
+                ? std::optional(writer::SpoolOptions{settings.spoolDir.value(), settings.spoolMaxBytes})
+                : std::nullopt
         );
 
         auto processor = binance::processor::HistoricalDataProcessor(context, std::move(writer), std::move(downloader), std::make_unique<Settings>(settings));
@@ -8,8 +8,6 @@
 #include <memory>
 #include <iostream>
 #include <vector>
-#include <unordered_map>
-#include <concurrentqueue/concurrentqueue.h>
 #include "binancehistoricaldatafetcher/binance_futures_orderbook.h"
 #include "binancehistoricaldatafetcher/binance_futures_book_builder.h"
 #include "binancehistoricaldatafetcher/binance_futures_orderbook_snapshots_socket_client.h"
@@ -18,6 +16,9 @@
 #include "common/models/enums.h"
 #include "common/network/socket/multicast_server.h"
 #include "common/network/socket/utils.h"
+#include "common/reference/reference_data_service.h"
+#include "common/sync/bounded_queue.h"
+#include "common/sync/wait_strategy.h"
 
 using namespace binance::models;
 using namespace common::models;
@@ -39,6 +40,10 @@ constexpr auto snap_pub_port = 20000;
 constexpr auto DEFAULT_PRODUCT_CLASS = FUTURES;
 constexpr auto DEFAULT_DATA_TYPE = SNAPSHOT;
 constexpr auto DATA_EVENT_QUEUE_SIZE = 1000;
+// a subscriber only wants the latest books, stale ones make way when the publisher falls behind
+constexpr auto DATA_EVENT_QUEUE_POLICY = common::sync::OverflowPolicy::DROP_OLDEST;
+// latency first: spin then yield, never park - use BUSY_SPIN on pinned cores
+constexpr auto DEFAULT_WAIT_POLICY = common::sync::WaitPolicy::SPIN_YIELD;
 
 
 std::vector<std::string> get_symbols(std::string syms) {
@@ -63,13 +68,10 @@ BinanceFuturesOnOpenSocketMessage build_on_open_message(const std::vector<std::s
    return msg;
 }
 
-auto build_exchange_info_map() {
-   std::unordered_map<std::string, ExchangeInfo> exchange_info;
-   ExchangeInfo info{};
-   info.tick_size = BTCUSDT_TICK_SIZE;
-   info.step_size = BTCUSDT_STEP_SIZE;
-   exchange_info["btcusdt"] = info;
-   return exchange_info;
+auto build_reference_data() {
+   common::reference::ReferenceDataService reference_data;
+   reference_data.add("btcusdt", BTCUSDT_TICK_SIZE, BTCUSDT_STEP_SIZE);
+   return reference_data;
 }
 
 struct orderbook_setings {
@@ -84,6 +86,9 @@ struct config {
    };
    std::string websocket_url{DEFAULT_WEBSOCKET_URL};
    std::vector<std::string> symbols{get_symbols(DEFAULT_SYMBOLS)};
+   common::sync::WaitOptions wait{DEFAULT_WAIT_POLICY};
+   size_t queue_capacity{DATA_EVENT_QUEUE_SIZE};
+   common::sync::OverflowPolicy queue_policy{DATA_EVENT_QUEUE_POLICY};
    BinanceFuturesOnOpenSocketMessage socket_open_msg{build_on_open_message(symbols)};
    common::network::sockets::SocketConfig socket_config{
       snap_pub_ip,
@@ -99,13 +104,14 @@ auto parse_config(int argc, char* argv[]) {
    return config{};
 }
 
-auto build_market_data_publisher(const config& cfg, moodycamel::ConcurrentQueue<DataEvent> &data_events_buffer) {
-   auto exchange_info = std::make_shared<std::unordered_map<std::string, ExchangeInfo>>(build_exchange_info_map());
+auto build_market_data_publisher(const config& cfg, common::sync::BoundedQueue<DataEvent> &data_events_buffer) {
+   const auto reference_data = std::make_shared<const common::reference::ReferenceDataService>(build_reference_data());
    auto multi_symbol_orderbook = std::make_shared<BinanceFuturesOrderbook>(
-      cfg.symbols,
+      reference_data->ids(cfg.symbols),
       DEFAULT_PRODUCT_CLASS,
-      exchange_info,
-      cfg.orderbook_settings.depth
+      reference_data,
+      cfg.orderbook_settings.depth,
+      cfg.wait
    );
    auto book_builder = std::make_unique<binance::processor::BinanceFuturesBookBuilder>(
       multi_symbol_orderbook,
@@ -113,30 +119,37 @@ auto build_market_data_publisher(const config& cfg, moodycamel::ConcurrentQueue<
          cfg.websocket_url,
          cfg.socket_open_msg,
          multi_symbol_orderbook->get_queues(),
-         exchange_info
+         reference_data
       ),
       data_events_buffer,
-      cfg.orderbook_settings.depth
+      cfg.orderbook_settings.depth,
+      1,
+      std::chrono::milliseconds{0},
+      cfg.wait
    );
    auto updates_socket = std::make_unique<common::network::sockets::MulticastServer>(cfg.socket_config);
    return std::make_unique<binance::processor::MarketDataPublisher>(
       std::move(updates_socket),
       std::move(book_builder),
-      data_events_buffer
+      data_events_buffer,
+      reference_data,
+      cfg.wait
    );
 }
 
 int main(const int argc, char **argv) {
    const auto cfg = parse_config(argc, argv);
-   auto data_events_buffer = moodycamel::ConcurrentQueue<DataEvent>(DATA_EVENT_QUEUE_SIZE);
+   common::sync::BoundedQueue<DataEvent> data_events_buffer(cfg.queue_capacity, cfg.queue_policy);
    const auto market_data_publisher = build_market_data_publisher(cfg, data_events_buffer);
    if (!market_data_publisher) {
       std::cerr << "ERROR::Failed to build MarketDataPublisher\n";
       return EXIT_FAILURE;
    }
    market_data_publisher->start();
+   common::sync::QueueMeter queue_meter;
    while (binance::processor::MarketDataPublisher::is_running()) {
       std::this_thread::sleep_for(std::chrono::seconds(1));
+      std::cout << "INFO::MarketDataPublisher queue " << queue_meter.sample(data_events_buffer) << "\n";
    }
    market_data_publisher->stop();
    return EXIT_SUCCESS;
@@ -0,0 +1,160 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// Trade archive parsing: the original getline / istringstream / stod path against the block tokenizer
+// with the locale-free parsers. Both run over the same in-memory csv, so only parsing is timed.
+//
+// usage: csv_parse_bench [BTCUSDT-trades-YYYY-MM.csv] [price_precision=2] [quantity_precision=3]
+// without a file SYNTHETIC_ROWS BTCUSDT-like rows are generated instead.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "common/parsing/csv_tokenizer.h"
+#include "common/parsing/number_parser.h"
+#include "common/rounding/fixed_point.h"
+
+namespace {
+
+    constexpr size_t SYNTHETIC_ROWS = 5'000'000;
+    constexpr int RUNS = 5;
+
+    struct Result {
+        uint64_t rows = 0;
+        int64_t checksum = 0; // keeps the parsed values observable
+    };
+
+    std::string decimal(const int64_t mantissa, const int precision) {
+        auto digits = std::to_string(mantissa);
+        if (precision == 0) {
+            return digits;
+        }
+        if (digits.size() <= static_cast<size_t>(precision)) {
+            digits.insert(0, static_cast<size_t>(precision) + 1 - digits.size(), '0');
+        }
+        digits.insert(digits.size() - static_cast<size_t>(precision), 1, '.');
+        return digits;
+    }
+
+    std::string synthetic_csv(const int price_precision, const int quantity_precision) {
+        const auto price_one = common::rounding::POW10[price_precision];
+        const auto quantity_one = common::rounding::POW10[quantity_precision];
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<int64_t> price(30'000 * price_one, 70'000 * price_one);
+        std::uniform_int_distribution<int64_t> quantity(1, 5 * quantity_one);
+        std::string csv = "id,price,qty,quote_qty,time,is_buyer_maker\n";
+        csv.reserve(SYNTHETIC_ROWS * 64);
+        int64_t time = 1'700'000'000'000;
+        for (size_t i = 0; i < SYNTHETIC_ROWS; ++i) {
+            const auto p = price(rng);
+            const auto q = quantity(rng);
+            time += static_cast<int64_t>(rng() % 20);
+            csv += std::to_string(4'000'000'000 + i);
+            csv += ',' + decimal(p, price_precision);
+            csv += ',' + decimal(q, quantity_precision);
+            csv += ',' + decimal(p * q, price_precision + quantity_precision);
+            csv += ',' + std::to_string(time);
+            csv += rng() & 1 ? ",true\n" : ",false\n";
+        }
+        return csv;
+    }
+
+    // what readFuturesTradeFile did before the tokenizer: a stream per line and a string per field
+    Result parse_getline(const std::string &csv) {
+        Result result;
+        std::istringstream file(csv);
+        std::string line;
+        std::getline(file, line);
+        while (std::getline(file, line)) {
+            std::istringstream ss(line);
+            std::string token;
+            std::getline(ss, token, ',');
+            const auto id = std::stoll(token);
+            std::getline(ss, token, ',');
+            const auto price = std::stod(token);
+            std::getline(ss, token, ',');
+            const auto qty = std::stod(token);
+            std::getline(ss, token, ',');
+            const auto quote_qty = std::stod(token);
+            std::getline(ss, token, ',');
+            const auto time = std::stoll(token);
+            std::getline(ss, token, ',');
+            const bool is_buyer_maker = token == "true";
+            result.checksum += id + time + is_buyer_maker + static_cast<int64_t>(price + qty + quote_qty);
+            ++result.rows;
+        }
+        return result;
+    }
+
+    Result parse_tokenizer(const std::string &csv, const int price_precision, const int quantity_precision) {
+        using common::rounding::decimal_codec;
+        const auto &price_codec = decimal_codec<int64_t>(price_precision);
+        const auto &quantity_codec = decimal_codec<int64_t>(quantity_precision);
+        const auto &notional_codec = decimal_codec<int64_t>(price_precision + quantity_precision);
+        Result result;
+        common::parsing::tokenize_rows<6>(csv, [&](const std::span<const std::string_view> fields) {
+            int64_t id, price, qty, quote_qty, time;
+            bool is_buyer_maker;
+            if (fields.size() < 6
+                || !common::parsing::parse_int64(fields[0], id)
+                || !price_codec.parse(fields[1], price)
+                || !quantity_codec.parse(fields[2], qty)
+                || !notional_codec.parse(fields[3], quote_qty)
+                || !common::parsing::parse_int64(fields[4], time)
+                || !common::parsing::parse_bool(fields[5], is_buyer_maker)) {
+                return; // header
+            }
+            result.checksum += id + time + is_buyer_maker + price + qty + quote_qty;
+            ++result.rows;
+        });
+        return result;
+    }
+
+    template<typename Fn>
+    void run(const std::string_view name, const size_t bytes, Fn &&fn) {
+        double best = 0;
+        Result result;
+        for (int i = 0; i < RUNS; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            result = fn();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = i == 0 ? elapsed.count() : std::min(best, elapsed.count());
+        }
+        std::cout << name << ": " << result.rows << " rows, best of " << RUNS << " " << best * 1e3 << " ms, "
+                  << static_cast<double>(result.rows) / best / 1e6 << " Mrows/s, "
+                  << static_cast<double>(bytes) / best / 1e6 << " MB/s (checksum " << result.checksum << ")" << std::endl;
+    }
+}
+
+int main(const int argc, char **argv) {
+    const int price_precision = argc > 2 ? std::stoi(argv[2]) : 2;
+    const int quantity_precision = argc > 3 ? std::stoi(argv[3]) : 3;
+    std::string csv;
+    if (argc > 1) {
+        std::ifstream file(argv[1], std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open " << argv[1] << std::endl;
+            return 1;
+        }
+        csv.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    } else {
+        csv = synthetic_csv(price_precision, quantity_precision);
+    }
+    std::cout << "csv: " << csv.size() << " bytes, price precision " << price_precision
+              << ", quantity precision " << quantity_precision << std::endl;
+
+    run("getline + stod", csv.size(), [&] { return parse_getline(csv); });
+    run("tokenizer + parse_int64 / DecimalCodec", csv.size(), [&] {
+        return parse_tokenizer(csv, price_precision, quantity_precision);
+    });
+    return 0;
+}
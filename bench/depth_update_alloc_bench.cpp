@@ -0,0 +1,134 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// Heap allocations per depth20 message on the live path, counted by a replaced operator new: the socket
+// client's on_payload (json parse, symbol lookup, price levels into a pooled update) and the book builder's
+// step (process_update, fill_snapshot into a pooled snapshot, the DataEvent handed to the batcher).
+// ObjectPool::allocations only sees pool misses, this sees everything.
+//
+// usage: depth_update_alloc_bench [messages=50000]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "binancehistoricaldatafetcher/binance_futures_orderbook.h"
+#include "binancehistoricaldatafetcher/binance_futures_orderbook_snapshots_socket_client.h"
+#include "common/memory/object_pool.h"
+#include "common/models/common_data_models.h"
+#include "common/reference/reference_data_service.h"
+
+namespace {
+    std::atomic<uint64_t> allocations{0};
+}
+
+void *operator new(const size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+    constexpr size_t LEVELS = 20;
+
+    // a depth20 stream message, chained to the previous one through pu. The deepest level of each side is
+    // removed on odd ids and comes back on even ones, so the book's map inserts a node every other message
+    std::string depth_message(const uint64_t update_id) {
+        const auto quantity = [update_id](const size_t i) {
+            if (i == LEVELS - 1 && update_id % 2 == 1) {
+                return std::string("0.000");
+            }
+            return "1." + std::to_string(100 + (i + update_id) % 900);
+        };
+        std::string payload = R"({"stream":"btcusdt@depth20@100ms","data":{"e":"depthUpdate","E":1700000000000,)"
+                              R"("T":1700000000000,"s":"BTCUSDT","U":)" + std::to_string(update_id)
+                              + R"(,"u":)" + std::to_string(update_id) + R"(,"pu":)" + std::to_string(update_id - 1)
+                              + R"(,"b":[)";
+        for (size_t i = 0; i < LEVELS; ++i) {
+            payload += (i == 0 ? "" : ",") + std::string(R"([")") + std::to_string(67000 - i) + R"(.10",")" + quantity(i) + R"("])";
+        }
+        payload += R"(],"a":[)";
+        for (size_t i = 0; i < LEVELS; ++i) {
+            payload += (i == 0 ? "" : ",") + std::string(R"([")") + std::to_string(67001 + i) + R"(.20",")" + quantity(i) + R"("])";
+        }
+        return payload + "]}}";
+    }
+}
+
+int main(const int argc, char **argv) {
+    const size_t messages = argc > 1 ? std::stoull(argv[1]) : 50'000;
+
+    auto reference_data = std::make_shared<common::reference::ReferenceDataService>();
+    const auto symbol = reference_data->add("BTCUSDT", 2, 3);
+    const std::shared_ptr<const common::reference::ReferenceDataService> shared_reference_data = reference_data;
+
+    binance::models::BinanceFuturesOrderbook book({symbol}, FUTURES, shared_reference_data, LEVELS);
+    downloader::BinanceFuturesOrderbookSnapshotsSocketClient client(
+        "wss://fstream.binance.com/stream", {"SUBSCRIBE", {"btcusdt@depth20@100ms"}, 1}, book.get_queues(), shared_reference_data);
+    auto snapshot_pool = common::memory::ObjectPool<OrderbookSnapshot>::create(
+        64, [](OrderbookSnapshot &snapshot) {
+            snapshot.bids.reserve(LEVELS);
+            snapshot.asks.reserve(LEVELS);
+        });
+
+    // built up front, so the counts below only see the live path
+    std::vector<std::string> payloads;
+    payloads.reserve(messages + 2);
+    for (uint64_t id = 1; id <= messages + 2; ++id) {
+        payloads.push_back(depth_message(id));
+    }
+
+    std::vector<DepthUpdate> updates;
+    uint64_t parse_allocations = 0;
+    uint64_t book_allocations = 0;
+    const auto step = [&](const std::string &payload) {
+        auto before = allocations.load(std::memory_order_relaxed);
+        client.on_payload(payload);
+        auto after = allocations.load(std::memory_order_relaxed);
+        parse_allocations += after - before;
+        before = after;
+        book.drain_updates(symbol, updates);
+        for (const auto &update : updates) {
+            if (book.process_update(*update) != 0) {
+                std::cerr << "update chain broken at " << update->final_update_id << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+            auto snapshot = snapshot_pool->acquire();
+            book.fill_snapshot(symbol, LEVELS, *snapshot);
+            // the batcher would queue it, the writer drops it back into the pool
+            DataEvent event(std::move(snapshot));
+        }
+        updates.clear();
+        book_allocations += allocations.load(std::memory_order_relaxed) - before;
+    };
+
+    // the first two messages grow the book and the drain vector, everything after them is steady state
+    step(payloads[0]);
+    step(payloads[1]);
+    parse_allocations = 0;
+    book_allocations = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 2; i < payloads.size(); ++i) {
+        step(payloads[i]);
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    const auto per_message = [messages](const uint64_t count) { return static_cast<double>(count) / static_cast<double>(messages); };
+    std::cout << messages << " depth" << LEVELS << " messages, " << elapsed.count() / static_cast<double>(messages) << " ns each\n"
+              << "allocations per message: on_payload " << per_message(parse_allocations)
+              << ", book builder " << per_message(book_allocations) << "\n"
+              << "pool misses: depth updates " << client.pool_allocations() << ", snapshots " << snapshot_pool->allocations()
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,94 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// Order book levels to the doubles of a snapshot array column at depth 20, 100 and 1000: scale_levels,
+// a static_cast<double>(mantissa) / divisor loop, against converting the mantissas through the bits of
+// 1.5 * 2^52, which the compiler vectorizes even without a packed int64 -> double instruction.
+//
+// usage: scale_levels_bench [snapshots per depth=200000]
+
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/io/scale_levels.h"
+#include "common/rounding/fixed_point.h"
+
+namespace {
+
+    using common::models::PriceLevel;
+
+    // both kept out of line, so each is vectorized the way it would be in to_tensor and no further
+    [[gnu::noinline]] void plain_cast(const PriceLevel *levels, const size_t count, const double price_divisor,
+                                      const double quantity_divisor, double *out) {
+        common::io::scale_levels(levels, count, price_divisor, quantity_divisor, out);
+    }
+
+    // exact for mantissas in [-2^51, 2^51), any other one sends the whole book through the cast
+    [[gnu::noinline]] void magic(const PriceLevel *levels, const size_t count, const double price_divisor,
+                                 const double quantity_divisor, double *out) {
+        constexpr int64_t MAGIC_BITS = 0x4338000000000000; // 1.5 * 2^52
+        constexpr double MAGIC = 0x1.8p52;
+        constexpr uint64_t RANGE_BIAS = uint64_t{1} << 51;
+        uint64_t out_of_range = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const int64_t price = levels[i].price;
+            const int64_t quantity = levels[i].quantity;
+            out_of_range |= (static_cast<uint64_t>(price) + RANGE_BIAS) | (static_cast<uint64_t>(quantity) + RANGE_BIAS);
+            out[2 * i] = (std::bit_cast<double>(price + MAGIC_BITS) - MAGIC) / price_divisor;
+            out[2 * i + 1] = (std::bit_cast<double>(quantity + MAGIC_BITS) - MAGIC) / quantity_divisor;
+        }
+        if (out_of_range >> 52 != 0) [[unlikely]] {
+            common::io::scale_levels(levels, count, price_divisor, quantity_divisor, out);
+        }
+    }
+
+    template<typename Fn>
+    double ns_per_snapshot(Fn fn, const std::vector<std::vector<PriceLevel>> &books, const size_t snapshots,
+                           std::vector<double> &out, double &checksum) {
+        // BTCUSDT precisions: 0.10 tick, 0.001 step
+        const double price_divisor = common::rounding::decimal_codec<int64_t>(2).divisor;
+        const double quantity_divisor = common::rounding::decimal_codec<int64_t>(3).divisor;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t s = 0; s < snapshots; ++s) {
+            const auto &book = books[s % books.size()];
+            fn(book.data(), book.size(), price_divisor, quantity_divisor, out.data());
+            checksum += out[s % out.size()];
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / static_cast<double>(snapshots);
+    }
+}
+
+int main(const int argc, char **argv) {
+    const size_t snapshots = argc > 1 ? std::stoull(argv[1]) : 200'000;
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int64_t> price(6'000'000, 12'000'000);
+    std::uniform_int_distribution<int64_t> quantity(1, 5'000'000);
+
+    double checksum = 0.0;
+    for (const size_t depth : {20, 100, 1000}) {
+        // a handful of distinct books, as many as fit in L1 / L2 would at the live depths
+        std::vector<std::vector<PriceLevel>> books(8, std::vector<PriceLevel>(depth));
+        for (auto &book : books) {
+            for (auto &level : book) {
+                level = {price(rng), quantity(rng)};
+            }
+        }
+        std::vector<double> out(depth * 2);
+        // warm up both paths before timing either
+        ns_per_snapshot(plain_cast, books, snapshots / 10 + 1, out, checksum);
+        ns_per_snapshot(magic, books, snapshots / 10 + 1, out, checksum);
+        const double cast = ns_per_snapshot(plain_cast, books, snapshots, out, checksum);
+        const double converted = ns_per_snapshot(magic, books, snapshots, out, checksum);
+        std::cout << "depth " << depth << ": scale_levels " << cast << " ns, 2^52 conversion " << converted
+                  << " ns per snapshot (speedup " << cast / converted << "x)" << std::endl;
+    }
+    std::cout << "checksum " << checksum << std::endl;
+    return 0;
+}
@@ -0,0 +1,134 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// Depth update hand off from the socket thread to a book builder: the MPMC moodycamel queue that path
+// used to run on against SpscRingBuffer, one producer and one consumer thread each.
+//
+//   throughput - the producer pushes messages as fast as the queue takes them, the consumer drains in
+//                batches of up to CONSUME_BATCH like build_book does
+//   latency    - ping-pong over a pair of queues, half the round trip is reported
+//
+// usage: spsc_queue_bench [messages=10000000], on a machine with at least two free cores
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <concurrentqueue/concurrentqueue.h>
+
+#include "common/sync/spsc_ring_buffer.h"
+
+namespace {
+
+    constexpr size_t RING_CAPACITY = 4096; // DEPTH_UPDATE_QUEUE_CAPACITY
+    constexpr size_t CONSUME_BATCH = 256;
+    constexpr size_t PING_PONGS = 1'000'000;
+
+    // sized like a moved depth update: the update ids and times plus the six pointers of its two level vectors
+    struct Message {
+        int64_t first_update_id;
+        int64_t final_update_id;
+        int64_t previous_final_update_id;
+        int64_t event_time;
+        std::array<int64_t, 6> levels;
+    };
+
+    struct Moodycamel {
+        moodycamel::ConcurrentQueue<Message> queue{RING_CAPACITY};
+
+        bool push(const Message &message) { return queue.enqueue(message); }
+
+        template<typename Fn>
+        size_t consume(Fn &&fn) {
+            std::array<Message, CONSUME_BATCH> batch;
+            const size_t count = queue.try_dequeue_bulk(batch.begin(), batch.size());
+            for (size_t i = 0; i < count; ++i) {
+                fn(batch[i]);
+            }
+            return count;
+        }
+    };
+
+    struct Spsc {
+        common::sync::SpscRingBuffer<Message> ring{RING_CAPACITY};
+
+        bool push(const Message &message) { return ring.try_emplace(message); }
+
+        template<typename Fn>
+        size_t consume(Fn &&fn) { return ring.consume(fn, CONSUME_BATCH); }
+    };
+
+    template<typename Queue>
+    void throughput(const std::string_view name, const size_t messages) {
+        Queue queue;
+        int64_t checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        std::thread consumer([&] {
+            size_t received = 0;
+            while (received < messages) {
+                received += queue.consume([&](const Message &message) { checksum += message.final_update_id; });
+            }
+        });
+        for (size_t i = 0; i < messages; ++i) {
+            const Message message{static_cast<int64_t>(i), static_cast<int64_t>(i), 0, 0, {}};
+            // the ring is bounded, the unbounded queue never refuses
+            while (!queue.push(message)) {
+            }
+        }
+        consumer.join();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << " throughput: " << static_cast<double>(messages) / elapsed.count() / 1e6
+                  << " M msgs/s (checksum " << checksum << ")" << std::endl;
+    }
+
+    template<typename Queue>
+    void latency(const std::string_view name) {
+        Queue ping;
+        Queue pong;
+        std::thread echo([&] {
+            size_t echoed = 0;
+            while (echoed < PING_PONGS) {
+                echoed += ping.consume([&](const Message &message) {
+                    while (!pong.push(message)) {
+                    }
+                });
+            }
+        });
+        std::vector<double> samples;
+        samples.reserve(PING_PONGS);
+        for (size_t i = 0; i < PING_PONGS; ++i) {
+            const auto sent = std::chrono::steady_clock::now();
+            while (!ping.push(Message{static_cast<int64_t>(i), 0, 0, 0, {}})) {
+            }
+            while (pong.consume([](const Message &) {}) == 0) {
+            }
+            const std::chrono::duration<double, std::nano> round_trip = std::chrono::steady_clock::now() - sent;
+            samples.push_back(round_trip.count() / 2);
+        }
+        echo.join();
+        std::ranges::sort(samples);
+        const auto percentile = [&](const double p) { return samples[static_cast<size_t>(p * static_cast<double>(samples.size() - 1))]; };
+        std::cout << name << " one way latency: p50 " << percentile(0.5) << " ns, p99 " << percentile(0.99)
+                  << " ns, p99.9 " << percentile(0.999) << " ns" << std::endl;
+    }
+}
+
+int main(const int argc, char **argv) {
+    const size_t messages = argc > 1 ? std::stoull(argv[1]) : 10'000'000;
+    // both sides spin, sharing one core only measures the scheduler
+    if (std::thread::hardware_concurrency() < 2) {
+        std::cerr << "spsc_queue_bench needs at least two cores" << std::endl;
+        return 1;
+    }
+    throughput<Moodycamel>("moodycamel::ConcurrentQueue", messages);
+    throughput<Spsc>("SpscRingBuffer", messages);
+    latency<Moodycamel>("moodycamel::ConcurrentQueue");
+    latency<Spsc>("SpscRingBuffer");
+    return 0;
+}
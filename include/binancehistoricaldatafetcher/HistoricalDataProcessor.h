@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <vector>
 
 #include "binancehistoricaldatafetcher/settings.h"
 #include "common/sync/producer_consumer.h"
@@ -12,10 +14,22 @@
 using namespace common::sync::producer_consumer;
 
 namespace downloader { class FileDownloader; }
-namespace writer { class QuestDBWriter; }
+namespace writer { class QuestDBWriter; struct ConnectionStats; }
+namespace common::sync { class StageStats; }
 
 namespace binance::processor {
 
+    constexpr auto STAGE_REPORT_INTERVAL = std::chrono::seconds(10);
+
+    // Runs a backfill as a pipeline of independently sized stages:
+    //
+    //   fetch (settings.parallelism threads) -> [prefetch queue] -> parse (settings.parseWorkers threads)
+    //       -> [DataEvent queue] -> write (QuestDBWriter thread)
+    //
+    // The bounded prefetch queue lets the fetch stage download the next archives while the current ones
+    // are inflated and parsed, and blocks it once settings.prefetch archives are waiting on disk.
+    // In streaming mode fetch and parse are fused into one stage, since the inflater consumes the bytes
+    // as they arrive. Every stage reports busy/idle time, the busiest one is the bottleneck.
     class HistoricalDataProcessor {
         std::shared_ptr<Context> context_;
         std::unique_ptr<writer::QuestDBWriter> writer_;
@@ -30,7 +44,12 @@ namespace binance::processor {
         ~HistoricalDataProcessor() = default;
 
         void process();
+
+    private:
+        void runProducerStages(common::sync::StageStats &fetch_stats, common::sync::StageStats &parse_stats) const;
+        static void reportStage(const common::sync::StageStats &stats, size_t threads);
+        // rates over the seconds between the two samples, previous may be empty
+        static void reportConnections(const std::vector<writer::ConnectionStats> &previous,
+            const std::vector<writer::ConnectionStats> &latest, double seconds);
     };
 }
-
-
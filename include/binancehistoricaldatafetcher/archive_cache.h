@@ -0,0 +1,71 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace downloader {
+
+    constexpr uint64_t DEFAULT_CACHE_MAX_BYTES = 50ULL * 1024 * 1024 * 1024;
+
+    // Persistent, content-addressed store of Binance archive zips.
+    //
+    // layout:
+    //   <root>/objects/<sha256>.zip             - verified archive bodies, one per distinct content
+    //   <root>/refs/<archive path>.sha256        - archive path (e.g. data/futures/um/monthly/...zip) -> digest
+    //   <root>/staging/                          - in-flight downloads, never read by lookups
+    //
+    // Objects are only committed after their digest matches the .CHECKSUM sidecar, so a ref always
+    // points at verified content. Eviction is least-recently-used by object mtime (touched on every hit)
+    // and runs after each commit and release until the store fits in max_bytes.
+    //
+    // lookup and commit pin the object they return until release() is called for it. Eviction skips
+    // pinned objects, so a path waiting in the parse queue or being parsed is never deleted, and an
+    // archive larger than max_bytes survives its own commit.
+    class ArchiveCache {
+        const std::filesystem::path root_;
+        const std::filesystem::path objects_dir_;
+        const std::filesystem::path refs_dir_;
+        const std::filesystem::path staging_dir_;
+        const uint64_t max_bytes_;
+        std::mutex mutex_;
+        // object file name -> number of lookup / commit results not released yet
+        std::unordered_map<std::string, size_t> pins_;
+
+    public:
+        explicit ArchiveCache(const std::filesystem::path &root, uint64_t max_bytes = DEFAULT_CACHE_MAX_BYTES);
+
+        // data/futures/um/... part of an archive url
+        [[nodiscard]] static std::string archive_key(const std::string &url);
+
+        // parses the "<sha256>  <file name>" body of a .CHECKSUM sidecar
+        [[nodiscard]] static std::optional<std::string> parse_checksum(const std::string &body);
+
+        // the returned object is pinned, see release()
+        [[nodiscard]] std::optional<std::filesystem::path> lookup(const std::string &url);
+
+        // unique path under staging/ on the same filesystem as objects/, so commit is a rename
+        [[nodiscard]] std::filesystem::path staging_path(const std::string &url) const;
+
+        // Moves a fully downloaded archive into the store if actual_sha256 matches expected_sha256.
+        // The staged file is always consumed; returns the pinned object path on success.
+        [[nodiscard]] std::optional<std::filesystem::path> commit(const std::string &url,
+            const std::filesystem::path &staged_file,
+            const std::string &actual_sha256,
+            const std::string &expected_sha256);
+
+        // unpins an object returned by lookup or commit, it may be evicted once nothing else holds it
+        void release(const std::filesystem::path &object);
+
+    private:
+        [[nodiscard]] std::filesystem::path ref_path(const std::string &url) const;
+        void evict();
+    };
+}
@@ -6,49 +6,77 @@
 #define BINANCEHISTORICDATAFETCHER_BINANCE_FUTURES_BOOK_BUILDER_H
 
 #include <atomic>
+#include <chrono>
 #include <string>
 #include <memory>
-#include <concurrentqueue/concurrentqueue.h>
 
 #include "binance_futures_orderbook.h"
 #include "binance_futures_orderbook_snapshots_socket_client.h"
+#include "common/memory/object_pool.h"
 #include "common/models/common_data_models.h"
+#include "common/sync/bounded_queue.h"
+#include "common/sync/wait_strategy.h"
 
 using namespace binance::models;
 using namespace common::models;
 
 namespace binance::processor {
 
+    // fresh pooled snapshots reserve room for a depth20 book on each side
+    constexpr size_t SNAPSHOT_POOL_LEVELS = 20;
+    constexpr size_t SNAPSHOT_POOL_PREWARM = 64;
+
     class BinanceFuturesBookBuilder {
+        using SnapshotPool = common::memory::ObjectPool<OrderbookSnapshot>;
+
         std::shared_ptr<BinanceFuturesOrderbook> order_books_;
         std::unique_ptr<downloader::BinanceFuturesOrderbookSnapshotsSocketClient> socket_client_;
         std::atomic<bool> is_running_;
-        std::vector<std::string> symbols_;
+        std::vector<types::Symbol> symbols_;
         std::vector<std::thread> builder_threads_;
+        std::vector<SnapshotPool::Owner> snapshot_pools_;
         const size_t depth_;
-        moodycamel::ConcurrentQueue<DataEvent>& event_queue_;
+        common::sync::BoundedQueue<DataEvent>& event_queue_;
+        // snapshots per bulk enqueue and how long the first of them may wait for the rest
+        const size_t batch_size_;
+        const std::chrono::milliseconds batch_timeout_;
+        const common::sync::WaitOptions wait_options_;
+        // rung whenever snapshots reach event_queue_ - own_events_ready_ unless the consumer brought its own
+        common::sync::WaitSignal own_events_ready_;
+        common::sync::WaitSignal *const events_ready_;
 
     public:
         BinanceFuturesBookBuilder(
             const std::shared_ptr<BinanceFuturesOrderbook> &order_books,
             std::unique_ptr<downloader::BinanceFuturesOrderbookSnapshotsSocketClient> socket_client,
-            moodycamel::ConcurrentQueue<DataEvent>& event_queue,
-            const size_t depth = 20) :
+            common::sync::BoundedQueue<DataEvent>& event_queue,
+            const size_t depth = 20,
+            const size_t batch_size = 1,
+            const std::chrono::milliseconds batch_timeout = std::chrono::milliseconds{0},
+            const common::sync::WaitOptions &wait = {},
+            common::sync::WaitSignal *events_ready = nullptr) :
         order_books_(order_books),
         socket_client_(std::move(socket_client)),
         is_running_(false),
+        symbols_(order_books_->get_symbols()),
         depth_(depth),
-        event_queue_(event_queue)
+        event_queue_(event_queue),
+        batch_size_(batch_size),
+        batch_timeout_(batch_timeout),
+        wait_options_(wait),
+        events_ready_(events_ready != nullptr ? events_ready : &own_events_ready_)
         {
-            auto orderbook_symbols = order_books_->get_symbols();
-            symbols_.insert(symbols_.end(), orderbook_symbols.begin(), orderbook_symbols.end());
         }
         ~BinanceFuturesBookBuilder() = default;
         void start();
         void stop();
+        [[nodiscard]] common::sync::WaitSignal &events_ready() { return *events_ready_; }
+        // pooled depth updates and snapshots allocated so far, flat once the pools are warm. The json parse
+        // of every message allocates on top of this, see bench/depth_update_alloc_bench
+        [[nodiscard]] uint64_t pool_allocations() const;
     private:
         void get_snapshots() const;
-        void build_book(const std::string &symbol) const;
+        void build_book(types::Symbol symbol, SnapshotPool *pool) const;
     };
 }
 #endif //BINANCEHISTORICDATAFETCHER_BINANCE_FUTURES_BOOK_BUILDER_H
\ No newline at end of file
@@ -6,105 +6,104 @@
 
 #include <string>
 #include <memory>
-#include <unordered_map>
-#include <concurrentqueue/concurrentqueue.h>
+#include <vector>
 
 #include "binancehistoricaldatafetcher/binance_orderbook.h"
 #include "binancehistoricaldatafetcher/binance_market_data_models.h"
 #include "common/models/enums.h"
+#include "common/sync/wait_strategy.h"
 
 using namespace common::models::enums;
 
 namespace binance::models {
 
     constexpr auto PROD_BINANCE_FUTURES_REST_URL = "https://fapi.binance.com/fapi/v1/depth";
+    // depth updates buffered per symbol, a full ring drops updates and the book resyncs on the gap
+    constexpr size_t DEPTH_UPDATE_QUEUE_CAPACITY = 4096;
 
     struct Context {
         unsigned long long last_update_id; // Last update ID in snapshot
         unsigned long long previous_u; // First update ID in event
         bool is_initialized = false;
-        std::shared_ptr<moodycamel::ConcurrentQueue<BinanceFuturesSocketDepthSnapshot>> price_level_queue;
+        std::shared_ptr<DepthUpdateQueue> price_level_queue;
     };
 
     class BinanceFuturesOrderbook final : public BinanceOrderbook<BinanceFuturesSocketDepthSnapshot> {
-        std::unordered_map<std::string, Context> context_;
+        // indexed by symbol id, untracked symbols have no queue
+        std::vector<Context> context_;
         size_t depth_;
+        const common::sync::WaitOptions wait_options_;
 
     public:
 
-        explicit BinanceFuturesOrderbook(const std::vector<std::string> &symbols,
+        explicit BinanceFuturesOrderbook(const std::vector<types::Symbol> &symbols,
             const Product product,
-            const std::shared_ptr<std::unordered_map<std::string, ExchangeInfo>> &exchange_info,
-            const size_t depth) :
-            BinanceOrderbook(symbols, product, exchange_info), depth_(depth) {
-
-            for (const auto &symbol : symbols) {
-                auto ctx = Context{};
-                ctx.price_level_queue = std::make_shared<moodycamel::ConcurrentQueue<BinanceFuturesSocketDepthSnapshot>>();
-                context_.emplace(symbol, ctx);
+            const std::shared_ptr<const common::reference::ReferenceDataService> &reference_data,
+            const size_t depth,
+            const common::sync::WaitOptions &wait = {}) :
+            BinanceOrderbook(symbols, product, reference_data), context_(reference_data->size()), depth_(depth),
+            wait_options_(wait) {
+
+            for (const auto symbol : symbols) {
+                context_.at(symbol).price_level_queue = std::make_shared<DepthUpdateQueue>(DEPTH_UPDATE_QUEUE_CAPACITY);
             }
         }
 
-        std::unordered_map<std::string, std::shared_ptr<moodycamel::ConcurrentQueue<BinanceFuturesSocketDepthSnapshot>>> get_queues() const {
-            std::unordered_map<std::string, std::shared_ptr<moodycamel::ConcurrentQueue<BinanceFuturesSocketDepthSnapshot>>> queues;
-            for (const auto & [symbol, ctx] : context_) {
-                queues.emplace(symbol, ctx.price_level_queue);
+        // indexed by symbol id like the contexts, handed to the socket client
+        std::vector<std::shared_ptr<DepthUpdateQueue>> get_queues() const {
+            std::vector<std::shared_ptr<DepthUpdateQueue>> queues;
+            queues.reserve(context_.size());
+            for (const auto &ctx : context_) {
+                queues.push_back(ctx.price_level_queue);
             }
             return queues;
         }
 
-        void init(const std::vector<std::string>& symbols) override;
+        void init(const std::vector<types::Symbol>& symbols) override;
 
         int process_update(const BinanceFuturesSocketDepthSnapshot& snapshot) override;
 
-        bool is_initialized(const std::string& symbol) const override {
-            const auto symbol_context = context_.find(symbol);
-            [[unlikely]] if (symbol_context == context_.end()) {
+        bool is_initialized(const types::Symbol symbol) const override {
+            [[unlikely]] if (!is_tracked(symbol)) {
                 throw std::runtime_error("Symbol not found");
             }
-            return symbol_context->second.is_initialized;
+            return context_[symbol].is_initialized;
         }
 
-        bool enque_update(const BinanceFuturesSocketDepthSnapshot& snapshot) {
-            const auto symbol_context = context_.find(snapshot.symbol);
-            [[unlikely]] if (symbol_context == context_.end()) {
+        bool enque_update(DepthUpdate update) {
+            [[unlikely]] if (!is_tracked(update->symbol)) {
                 return false;
             }
-            symbol_context->second.price_level_queue->enqueue(snapshot);
-            return true;
+            const auto symbol = update->symbol;
+            return context_[symbol].price_level_queue->try_push(std::move(update));
         }
 
-        std::optional<std::vector<BinanceFuturesSocketDepthSnapshot>> deque_update(const std::string& symbol) {
-            const auto it = context_.find(symbol);
-            [[unlikely]]  if (it == context_.end()) {
-                return std::nullopt;
+        // moves the queued updates of symbol into updates, which is cleared first and keeps its
+        // capacity between calls - an empty poll is two atomic loads. Returns the number drained.
+        size_t drain_updates(const types::Symbol symbol, std::vector<DepthUpdate> &updates) {
+            updates.clear();
+            [[unlikely]] if (!is_tracked(symbol)) {
+                return 0;
             }
-            const auto& queue = it->second.price_level_queue;
-            const size_t size = queue->size_approx();
-            if (size == 0) {
-                return std::nullopt;
+            auto &queue = *context_[symbol].price_level_queue;
+            if (updates.capacity() < queue.capacity()) {
+                updates.reserve(queue.capacity());
             }
-            std::vector<BinanceFuturesSocketDepthSnapshot> snapshots(size);
-            const size_t actual = queue->try_dequeue_bulk(snapshots.data(), size);
-            if (actual == 0) {
-                return std::nullopt;
-            }
-            snapshots.resize(actual);
-            return snapshots;
+            return queue.consume([&updates](DepthUpdate &update) { updates.push_back(std::move(update)); });
         }
 
-        void init_order_book(const std::string& symbol);
+        void init_order_book(types::Symbol symbol);
 
-        std::vector<std::string> get_symbols() const {
-            std::vector<std::string> symbols;
-            for (const auto &symbol: context_ | std::views::keys) {
-                symbols.push_back(symbol);
-            }
-            return symbols;
+        const std::vector<types::Symbol> &get_symbols() const {
+            return symbols_;
         }
     private:
-        void apply_update(const std::string &symbol, const std::vector<PriceLevel> &price_level, bool is_bid);
+        [[nodiscard]] bool is_tracked(const types::Symbol symbol) const {
+            return symbol < context_.size() && context_[symbol].price_level_queue != nullptr;
+        }
+
+        void apply_update(types::Symbol symbol, const std::vector<PriceLevel> &price_level, bool is_bid);
 
-        std::optional<BinanceFuturesOrderbookSnapshot> fetch_snapshot(const std::string &symbol) const;
+        std::optional<BinanceFuturesOrderbookSnapshot> fetch_snapshot(types::Symbol symbol) const;
     };
-}
\ No newline at end of file
+}
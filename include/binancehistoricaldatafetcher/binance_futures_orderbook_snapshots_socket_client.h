@@ -8,36 +8,55 @@
 #include <websocketpp/config/asio_client.hpp>
 #include <websocketpp/websocketpp/client.hpp>
 #include <memory>
-#include <unordered_map>
+#include <vector>
 #include <string>
-#include <concurrentqueue/concurrentqueue.h>
 #include <nlohmann/json.hpp>
 
 
 #include "binance_futures_socket_client.h"
 #include "binance_market_data_models.h"
 #include "common/models/common_data_models.h"
+#include "common/reference/reference_data_service.h"
 
 using namespace binance::models;
 using namespace common::models;
 
 namespace downloader {
-    class BinanceFuturesOrderbookSnapshotsSocketClient final : public BinanceFuturesSocketClient<BinanceFuturesSocketDepthSnapshot> {
-        const std::shared_ptr<std::unordered_map<std::string, ExchangeInfo>> exchange_info_;
+    // price levels reserved per side in a fresh pooled update, a depth20 stream never grows them
+    constexpr size_t DEPTH_UPDATE_LEVELS = 20;
+    constexpr size_t DEPTH_UPDATE_POOL_PREWARM = 256;
+
+    class BinanceFuturesOrderbookSnapshotsSocketClient final : public BinanceFuturesSocketClient<DepthUpdate> {
+        const std::shared_ptr<const common::reference::ReferenceDataService> reference_data_;
+        // acquired on the socket thread only, released by the book builder threads
+        common::memory::ObjectPool<BinanceFuturesSocketDepthSnapshot>::Owner depth_pool_;
 
     public:
         explicit BinanceFuturesOrderbookSnapshotsSocketClient(const std::string &uri,
             const BinanceFuturesOnOpenSocketMessage &open_msg,
-            const std::unordered_map<std::string,std::shared_ptr<moodycamel::ConcurrentQueue<BinanceFuturesSocketDepthSnapshot>>> &events_queue,
-            const std::shared_ptr<std::unordered_map<std::string, ExchangeInfo>> &exchange_info) :
+            const std::vector<std::shared_ptr<DepthUpdateQueue>> &events_queue,
+            const std::shared_ptr<const common::reference::ReferenceDataService> &reference_data) :
             BinanceFuturesSocketClient(uri, open_msg, events_queue),
-            exchange_info_(exchange_info) {}
+            reference_data_(reference_data),
+            depth_pool_(common::memory::ObjectPool<BinanceFuturesSocketDepthSnapshot>::create(
+                DEPTH_UPDATE_POOL_PREWARM,
+                [](BinanceFuturesSocketDepthSnapshot &update) {
+                    update.bids.reserve(DEPTH_UPDATE_LEVELS);
+                    update.asks.reserve(DEPTH_UPDATE_LEVELS);
+                })) {}
+
+        [[nodiscard]] uint64_t pool_allocations() const { return depth_pool_->allocations(); }
 
         void on_message(websocketpp::connection_hdl, client::message_ptr msg) override;
 
-        void from_json(const nlohmann::json &j, BinanceFuturesSocketDepthSnapshot &snapshot) const;
+        // parses one stream message and queues the depth update for its symbol's book builder
+        void on_payload(const std::string &payload);
+
+        [[nodiscard]] bool from_json(const nlohmann::json &j, BinanceFuturesSocketDepthSnapshot &snapshot) const;
 
-        void parse_price_levels(const nlohmann::json &j, PriceLevel &price_level, const std::string &symbol) const;
+        [[nodiscard]] static bool parse_price_levels(const nlohmann::json &j, PriceLevel &price_level,
+                                                     const common::reference::PriceCodec &price,
+                                                     const common::reference::PriceCodec &quantity) noexcept;
     };
 }
 #endif //BINANCEHISTORICDATAFETCHER_BINANCE_FUTURES_ORDERBOOK_SNAPSHOTS_SOCKET_CLIENT_H
\ No newline at end of file
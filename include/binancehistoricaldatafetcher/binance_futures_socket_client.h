@@ -10,14 +10,14 @@
 #include <thread>
 #include <string>
 #include <utility>
-#include <unordered_map>
+#include <vector>
 #include <memory>
 #include <atomic>
 
-#include <concurrentqueue/concurrentqueue.h>
 #include <nlohmann/json.hpp>
 
 #include "binancehistoricaldatafetcher/binance_market_data_models.h"
+#include "common/sync/spsc_ring_buffer.h"
 
 using namespace binance::models;
 
@@ -55,17 +55,18 @@ namespace downloader {
         websocketpp::connection_hdl hdl_;
         std::unique_ptr<std::thread> worker_thread_;
         BinanceFuturesOnOpenSocketMessage socket_open_msg_;
-        std::unordered_map<std::string, std::shared_ptr<moodycamel::ConcurrentQueue<SocketEvent>>> event_queues_;
+        // indexed by symbol id, null for symbols without a book
+        std::vector<std::shared_ptr<common::sync::SpscRingBuffer<SocketEvent>>> event_queues_;
         std::atomic<bool> should_reconnect_{true};
         std::atomic<bool> is_reconnecting_{false};
 
     public:
         explicit BinanceFuturesSocketClient(std::string uri,
             const BinanceFuturesOnOpenSocketMessage &open_msg,
-            std::unordered_map<std::string, std::shared_ptr<moodycamel::ConcurrentQueue<SocketEvent>>> events_queue) :
+            std::vector<std::shared_ptr<common::sync::SpscRingBuffer<SocketEvent>>> events_queue) :
         uri_(std::move(uri)),
         socket_open_msg_(open_msg),
-        event_queues_(events_queue) {}
+        event_queues_(std::move(events_queue)) {}
 
         virtual ~BinanceFuturesSocketClient() = default;
 
@@ -10,7 +10,9 @@
 
 #include "constants.h"
 #include "common/models/enums.h"
+#include "common/memory/object_pool.h"
 #include "common/models/common_data_models.h"
+#include "common/sync/spsc_ring_buffer.h"
 
 using namespace common::models::enums;
 using namespace common::models;
@@ -40,7 +42,7 @@ namespace binance::models {
         long long transaction_time; // "T"
         std::vector<PriceLevel> bids; // "bids"
         std::vector<PriceLevel> asks; // "asks"
-        std::string symbol;
+        types::Symbol symbol;
     };
 
     inline void from_json(const nlohmann::json &j, BinanceFuturesOrderbookSnapshot &snapshot, const int price_precision, const int quantity_precision) {
@@ -68,7 +70,7 @@ namespace binance::models {
         std::string event_type;          // "e"
         long long event_time;            // "E"
         long long transaction_time;      // "T"
-        std::string symbol;             // "s"
+        types::Symbol symbol;           // "s", interned by the socket client
         unsigned long long first_update_id; // "U"
         unsigned long long final_update_id; // "u"
         unsigned long long previous_final_update_id; // "pu"
@@ -76,6 +78,11 @@ namespace binance::models {
         std::vector<PriceLevel> asks; // "a"
     };
 
+    // depth updates are recycled through the socket client's pool, the book builder hands them back
+    using DepthUpdate = common::memory::Pooled<BinanceFuturesSocketDepthSnapshot>;
+    // one socket thread produces, the symbol's book builder consumes
+    using DepthUpdateQueue = common::sync::SpscRingBuffer<DepthUpdate>;
+
     struct BinanceFuturesOnOpenSocketMessage {
         std::string method;
         std::vector<std::string> params;
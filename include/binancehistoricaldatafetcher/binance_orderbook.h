@@ -9,6 +9,8 @@
 
 #include "common/models/multi_symbol_orderbook.h"
 #include "common/models/enums.h"
+#include "common/models/types.h"
+#include "common/reference/reference_data_service.h"
 
 using namespace common::models;
 using namespace common::models::enums;
@@ -18,38 +20,44 @@ namespace binance::models {
     class BinanceOrderbook  {
     protected:
         MultiSymbolOrderbook multi_symbol_orderbook_;
-        const std::vector<std::string> symbols_;
+        const std::vector<types::Symbol> symbols_;
         const Product product_;
-        std::shared_ptr<std::unordered_map<std::string, ExchangeInfo>> exchange_info_;
+        std::shared_ptr<const common::reference::ReferenceDataService> reference_data_;
 
     public:
-        explicit BinanceOrderbook(const std::vector<std::string>& symbols,
+        explicit BinanceOrderbook(const std::vector<types::Symbol>& symbols,
             const Product product,
-            const std::shared_ptr<std::unordered_map<std::string, ExchangeInfo>> &exchange_info) :
+            const std::shared_ptr<const common::reference::ReferenceDataService> &reference_data) :
             multi_symbol_orderbook_(symbols), symbols_(symbols), product_(product),
-            exchange_info_(exchange_info) {};
+            reference_data_(reference_data) {};
 
         virtual ~BinanceOrderbook() = default;
 
-        virtual void init(const std::vector<std::string>& symbols) = 0;
+        virtual void init(const std::vector<types::Symbol>& symbols) = 0;
 
         virtual int process_update(const UpdateMsg& snapshot) = 0;
 
-        OrderbookSnapshot get_snapshot(const std::string& symbol, const size_t depth) {
-            const auto levels = multi_symbol_orderbook_.get_levels(symbol, depth);
-            // Construct the OrderbookSnapshot
+        OrderbookSnapshot get_snapshot(const types::Symbol symbol, const size_t depth) {
             OrderbookSnapshot snapshot;
+            fill_snapshot(symbol, depth, snapshot);
+            return snapshot;
+        }
+
+        // overwrites every field of snapshot, so a recycled one keeps its level capacity
+        void fill_snapshot(const types::Symbol symbol, const size_t depth, OrderbookSnapshot &snapshot) {
+            multi_symbol_orderbook_.copy_levels(symbol, depth, snapshot.bids, snapshot.asks);
             snapshot.symbol = symbol;
-            snapshot.bids = std::get<0>(levels);
-            snapshot.asks = std::get<1>(levels);
             // set snapshot time to current time in milliseconds
             snapshot.snapshot_time = std::chrono::duration_cast<std::chrono::milliseconds>(
                     std::chrono::system_clock::now().time_since_epoch()).count();
             snapshot.product_type = product_;
-            return snapshot;
         }
 
-        [[nodiscard]] virtual bool is_initialized(const std::string &symbol) const {
+        [[nodiscard]] const common::reference::ReferenceDataService &reference_data() const noexcept {
+            return *reference_data_;
+        }
+
+        [[nodiscard]] virtual bool is_initialized(const types::Symbol symbol) const {
             return false;
         }
     };
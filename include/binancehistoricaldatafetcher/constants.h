@@ -9,11 +9,20 @@ namespace binance::settings {
     constexpr auto APP_NAME = "BinanceHistoricDataFetcher";
     constexpr auto APP_DESCRIPTION = "A tool to fetch and store historical data from Binance. Futures Supported Only in v0.0.1";
     constexpr auto BASE_URL = "https://data.binance.vision/";
-    constexpr auto FUTURES_BASE = "/?prefix=data/futures/um/";
+    constexpr auto FUTURES_BASE = "data/futures/um/";
     constexpr auto TRADE_URL = "/trades";
     constexpr auto OHLCV_URL = "/klines";
-    constexpr auto BATCH_SIZE = 5000;
-    constexpr auto BUFFER_SIZE = 250000;
+    // encoded ILP bytes per QuestDB flush, the tuner may move it with --autoTuneFlush
+    constexpr auto DEFAULT_FLUSH_KB = 1024;
+    // row blocks of batchRows each, so the queue holds at most this many times batchRows rows
+    constexpr auto DEFAULT_EVENT_QUEUE_BLOCKS = 256;
     constexpr auto FLUSH_INTERVAL_MS = 2000;
+    constexpr auto DEFAULT_PARALLELISM = 4;
+    constexpr auto DEFAULT_PARSE_THREADS = 1;
+    constexpr auto DEFAULT_PARSE_WORKERS = 2;
+    constexpr auto DEFAULT_PREFETCH_ARCHIVES = 4;
+    constexpr auto DEFAULT_CACHE_MAX_GB = 50;
+    constexpr auto DEFAULT_RANGE_SPLIT_MB = 256;
+    constexpr auto DEFAULT_SPOOL_MAX_GB = 4;
 }
 #endif //BINANCEHISTORICDATAFETCHER_CONSTANTS_H
\ No newline at end of file
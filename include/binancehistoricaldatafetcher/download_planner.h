@@ -0,0 +1,44 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/models/enums.h"
+
+namespace downloader {
+
+    using common::models::enums::DownloadType;
+
+    // one archive to fetch and the part of it that falls inside the requested range
+    struct ArchivePeriod {
+        DownloadType granularity;     // MONTHLY or DAILY, never AUTO
+        std::string date;             // YYYY-MM for monthly archives, YYYY-MM-DD for daily ones
+        int64_t from_ms;              // inclusive, epoch millis
+        int64_t to_ms;                // exclusive, epoch millis
+    };
+
+    // Covers the half open range [start, end) with Binance archives.
+    //
+    //   MONTHLY - every month touching the range, rows outside it are trimmed while parsing
+    //   DAILY   - one archive per day
+    //   AUTO    - monthly archives for the complete months inside the range, daily archives for the
+    //             ragged edges, so 2024-01-15..2024-06-03 becomes 17 daily + 4 monthly + 2 daily requests
+    //             instead of ~140 daily ones or 6 mostly unused months
+    [[nodiscard]] std::vector<ArchivePeriod> plan_archives(
+        std::chrono::year_month_day start,
+        std::chrono::year_month_day end,
+        DownloadType download_type);
+
+    // YYYY-MM-DD, throws std::invalid_argument on anything else
+    [[nodiscard]] std::chrono::year_month_day parse_date(const std::string &date);
+
+    [[nodiscard]] std::string format_date(std::chrono::year_month_day date);
+
+    [[nodiscard]] std::string format_month(std::chrono::year_month_day date);
+}
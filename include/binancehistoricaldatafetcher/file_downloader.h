@@ -9,46 +9,128 @@
 #include <filesystem>
 #include <vector>
 #include <chrono>
+#include <atomic>
+#include <optional>
+#include <span>
+#include <string_view>
 
+#include "archive_cache.h"
 #include "binance_market_data_models.h"
-#include "concurrentqueue/concurrentqueue.h"
+#include "http_fetcher.h"
 
+#include "common/io/job_manifest.h"
 #include "common/models/enums.h"
+#include "common/models/types.h"
+#include "common/reference/reference_data_service.h"
+#include "common/sync/bounded_queue.h"
 
 using namespace common::models;
 using namespace common::models::enums;
 
 // forward declare to prevent circular import
 namespace common::sync::producer_consumer { struct Context; }
+namespace common::crypto { class Sha256; }
 
 namespace downloader {
 
+    // klines archives carry 12 columns, trades 6
+    constexpr size_t CSV_MAX_FIELDS = 12;
+    constexpr size_t CSV_READ_CHUNK_SIZE = 4 * 1024 * 1024;
+    // rows per trade / candle block handed to the writer
+    constexpr size_t DEFAULT_BATCH_ROWS = 4096;
+
+    using CsvRow = std::span<const std::string_view>;
+
+    // a single (symbol, archive) pair pulled from the shared work list by the fetch stage
+    struct DownloadUnit {
+        std::string symbol; // as typed by the user, used for urls and manifest keys
+        types::Symbol symbol_id;
+        std::string url;
+        DownloadType granularity;
+        // rows outside [from_ms, to_ms) belong to the archive but not to the requested range
+        int64_t from_ms;
+        int64_t to_ms;
+    };
+
+    // rows of one archive that did not parse exactly, reported in a single line once the archive is done.
+    // Bumped from the parse threads, only on these slow paths.
+    struct RowIssues {
+        std::atomic<uint64_t> rounded{0};  // a value finer than the archive scale, kept rounded
+        std::atomic<uint64_t> rejected{0}; // malformed, dropped
+    };
+
+    // an archive on local disk waiting for the parse stage
+    struct FetchedArchive {
+        DownloadUnit unit;
+        std::filesystem::path path;
+        bool scratch; // true if the file is deleted after parsing, false for archive cache objects, released after parsing
+    };
+
+    // every (symbol, archive) pair covering [start_date, end_date]; symbol_id is left at 0, so this needs
+    // no reference data and is enough to list what a job would fetch. Logs and returns nothing for bad dates.
+    [[nodiscard]] std::vector<DownloadUnit> plan_units(const std::vector<std::string> &symbols, DataType data_type,
+        DownloadType download_type, const std::string &start_date, const std::string &end_date);
+
     class FileDownloader {
-        moodycamel::ConcurrentQueue<DataEvent> &queue_;
+        common::sync::BoundedQueue<DataEvent> &queue_;
         std::shared_ptr<common::sync::producer_consumer::Context> &context_;
+        const std::shared_ptr<const common::reference::ReferenceDataService> reference_data_;
         std::filesystem::path tmp_dir_;
         std::filesystem::path tmp_dir_file_ ;
         const DataType data_type_;
         const Product product_type_;
         const DownloadType download_type_;
+        const bool streaming_;
+        const std::shared_ptr<ArchiveCache> cache_;
+        const HttpFetcher fetcher_;
+        const std::shared_ptr<common::io::JobManifest> manifest_;
+        const size_t parse_threads_;
+        const size_t batch_rows_;
+        mutable std::atomic<uint64_t> bytes_downloaded_{0};
+        mutable std::atomic<uint64_t> next_scratch_id_{0};
 
     public:
         FileDownloader(
             DataType dataType,
             Product productType,
             DownloadType downloadType,
-            moodycamel::ConcurrentQueue<DataEvent> &queue,
-            std::shared_ptr<common::sync::producer_consumer::Context> &context);
+            common::sync::BoundedQueue<DataEvent> &queue,
+            std::shared_ptr<common::sync::producer_consumer::Context> &context,
+            const std::shared_ptr<const common::reference::ReferenceDataService> &referenceData,
+            bool streaming = false,
+            const std::shared_ptr<ArchiveCache> &cache = nullptr,
+            const HttpFetcherOptions &fetch_options = {},
+            const std::shared_ptr<common::io::JobManifest> &manifest = nullptr,
+            size_t parseThreads = 1,
+            size_t batchRows = DEFAULT_BATCH_ROWS);
         ~FileDownloader();
-        void download(const std::vector<std::string> &symbol, const std::string &start_date, const std::string &end_date) const;
+        [[nodiscard]] std::vector<DownloadUnit> plan(const std::vector<std::string> &symbols, const std::string &start_date, const std::string &end_date) const;
+        // plan minus the units a resumed manifest already has as flushed
+        [[nodiscard]] std::vector<DownloadUnit> pendingUnits(const std::vector<std::string> &symbols, const std::string &start_date, const std::string &end_date) const;
+
+        // pipeline stages, see HistoricalDataProcessor - all of them are safe to call from many threads
+        [[nodiscard]] std::optional<FetchedArchive> fetchUnit(const DownloadUnit &unit) const;
+        void parseUnit(const FetchedArchive &archive) const;
+        // fetch and parse fused into one pass, used instead of the two above in streaming mode
+        void streamUnit(const DownloadUnit &unit) const;
+
+        [[nodiscard]] bool streaming() const { return streaming_; }
+        [[nodiscard]] uint64_t bytesDownloaded() const { return bytes_downloaded_.load(); }
 
     private:
-        [[nodiscard]] bool downloadFile(const std::string &url) const;
-        [[nodiscard]] bool unzipFile() const;
-        void readFuturesTradeFile(const std::string& url, const std::string& symbol) const;
-        void readCandleFile(const std::string& url, const std::string& symbol) const;
-        void deleteFile() const;
-        [[nodiscard]] std::vector<std::string> createUrls(const std::string &symbol, const std::string &start_date, const std::string &end_date) const;
-        static std::chrono::year_month_day parseDateString(const std::string &dateString);
+        void completeUnit(const DownloadUnit &unit) const;
+        void recordState(const DownloadUnit &unit, common::io::UnitState state) const;
+        [[nodiscard]] bool streamFile(const DownloadUnit &unit, const std::optional<std::string> &expected_sha256) const;
+        [[nodiscard]] bool downloadFile(const std::string &url, const std::filesystem::path &file_path, common::crypto::Sha256 *hasher) const;
+        [[nodiscard]] std::optional<std::string> fetchChecksum(const std::string &url) const;
+        [[nodiscard]] bool parseArchiveFile(const std::filesystem::path &archive, const DownloadUnit &unit) const;
+        // csv -> batch parser feeding the queue, rows are parsed on parse_threads_ threads in order
+        [[nodiscard]] auto makeRowParser(const DownloadUnit &unit, RowIssues &issues) const;
+        // append the row to batch, which starts out EMPTY for every block
+        void parseRow(CsvRow fields, const DownloadUnit &unit, DataEvent &batch, RowIssues &issues) const;
+        void parseTradeRow(CsvRow fields, const DownloadUnit &unit, DataEvent &batch, RowIssues &issues) const;
+        void parseCandleRow(CsvRow fields, const DownloadUnit &unit, DataEvent &batch, RowIssues &issues) const;
+        static void reportRowIssues(const DownloadUnit &unit, const RowIssues &issues);
+        static bool isHeaderRow(CsvRow fields);
     };
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace common::crypto { class Sha256; }
+
+namespace downloader {
+
+    constexpr int DEFAULT_MAX_ATTEMPTS = 6;
+    constexpr auto DEFAULT_BASE_BACKOFF = std::chrono::milliseconds(500);
+    constexpr auto DEFAULT_MAX_BACKOFF = std::chrono::milliseconds(30000);
+    constexpr uint64_t DEFAULT_RANGE_SPLIT_BYTES = 256ULL * 1024 * 1024;
+    constexpr size_t DEFAULT_RANGE_CONNECTIONS = 4;
+    // abort a transfer that stays below 1 byte/s for this long so it can be resumed
+    constexpr std::chrono::seconds STALLED_TRANSFER_TIMEOUT{30};
+
+    struct HttpFetcherOptions {
+        int max_attempts{DEFAULT_MAX_ATTEMPTS};
+        std::chrono::milliseconds base_backoff{DEFAULT_BASE_BACKOFF};
+        std::chrono::milliseconds max_backoff{DEFAULT_MAX_BACKOFF};
+        // files larger than this are fetched as parallel byte ranges when downloading to disk, 0 disables
+        uint64_t range_split_bytes{DEFAULT_RANGE_SPLIT_BYTES};
+        size_t range_connections{DEFAULT_RANGE_CONNECTIONS};
+    };
+
+    // HTTP GET with retries. A dropped transfer is resumed with a Range request from the last byte
+    // delivered, so consumers see one contiguous body no matter how many attempts it took.
+    // Retries back off exponentially with full jitter; 4xx responses other than 408/429 are final.
+    class HttpFetcher {
+        const HttpFetcherOptions options_;
+
+    public:
+        using DataCallback = std::function<bool(std::string_view)>;
+
+        explicit HttpFetcher(const HttpFetcherOptions &options = {}) : options_(options) {}
+
+        // streams the body in order to on_data; returns false if the body could not be completed.
+        // Returning false from on_data aborts without retrying.
+        [[nodiscard]] bool fetch(const std::string &url, const DataCallback &on_data, uint64_t &bytes_received) const;
+
+        // small bodies such as .CHECKSUM sidecars
+        [[nodiscard]] std::optional<std::string> fetch_text(const std::string &url) const;
+
+        // downloads to path, splitting into parallel ranges for large files; hasher sees the full body in order
+        [[nodiscard]] bool fetch_to_file(const std::string &url, const std::filesystem::path &path,
+            common::crypto::Sha256 *hasher, uint64_t &bytes_received) const;
+
+    private:
+        enum class AttemptResult {
+            COMPLETE,
+            RETRY,
+            FAILED,
+        };
+
+        [[nodiscard]] bool fetch_range(const std::string &url, uint64_t offset, std::optional<uint64_t> last_byte,
+            const DataCallback &on_data, uint64_t &bytes_received) const;
+
+        [[nodiscard]] AttemptResult attempt(const std::string &url, uint64_t offset, std::optional<uint64_t> last_byte,
+            const DataCallback &on_data, uint64_t &delivered) const;
+
+        [[nodiscard]] bool fetch_ranges_to_file(const std::string &url, const std::filesystem::path &path,
+            uint64_t content_length, uint64_t &bytes_received) const;
+
+        // content length if the server advertises byte range support
+        [[nodiscard]] std::optional<uint64_t> probe_ranged_length(const std::string &url) const;
+
+        [[nodiscard]] std::chrono::milliseconds backoff(int attempt) const;
+    };
+}
@@ -6,11 +6,13 @@
 #include <atomic>
 #include <memory>
 #include <thread>
-#include <concurrentqueue/concurrentqueue.h>
 
 #include "binance_futures_book_builder.h"
 #include "common/network/socket/multicast_server.h"
 #include "common/models/common_data_models.h"
+#include "common/reference/reference_data_service.h"
+#include "common/sync/bounded_queue.h"
+#include "common/sync/wait_strategy.h"
 
 using namespace common::models;
 
@@ -20,18 +22,25 @@ namespace binance::processor {
         static std::atomic_bool is_running_;
         std::unique_ptr<common::network::sockets::MulticastServer> updates_socket_;
         std::unique_ptr<BinanceFuturesBookBuilder> book_builder_;
-        moodycamel::ConcurrentQueue<DataEvent>& data_event_queue_;
+        common::sync::BoundedQueue<DataEvent>& data_event_queue_;
+        // resolves the symbol names published on the wire
+        const std::shared_ptr<const common::reference::ReferenceDataService> reference_data_;
         std::thread server_thread_;
         std::atomic<size_t> sequence_id_ = 1;
+        const common::sync::WaitOptions wait_options_;
 
     public:
         explicit  MarketDataPublisher(
             std::unique_ptr<common::network::sockets::MulticastServer> updates_socket,
             std::unique_ptr<BinanceFuturesBookBuilder> book_builder,
-            moodycamel::ConcurrentQueue<DataEvent>& data_event_queue
+            common::sync::BoundedQueue<DataEvent>& data_event_queue,
+            const std::shared_ptr<const common::reference::ReferenceDataService> &reference_data,
+            const common::sync::WaitOptions &wait = {}
         ) : updates_socket_(std::move(updates_socket)),
             book_builder_(std::move(book_builder)),
-            data_event_queue_(data_event_queue) {};
+            data_event_queue_(data_event_queue),
+            reference_data_(reference_data),
+            wait_options_(wait) {};
 
         ~MarketDataPublisher() noexcept {
             if (is_running()) {
@@ -18,6 +18,10 @@ namespace binance::processor {
         std::unique_ptr<BinanceFuturesBookBuilder> book_builder_;
         std::unique_ptr<writer::QuestDBWriter> quest_db_writer_;
         std::thread writer_thread_;
+        // between start() and the stop() that tears the builders and the writer thread down
+        std::atomic<bool> started_{false};
+        // set by the writer thread when write() threw, stop() then reports failure
+        std::atomic<bool> writer_failed_{false};
     public:
         OrderbookArchiver(
             std::unique_ptr<BinanceFuturesBookBuilder> book_builder,
@@ -35,5 +39,12 @@ namespace binance::processor {
 
         void start();
         int stop() noexcept;
+
+        // the writer thread died, the archiver should be stopped
+        [[nodiscard]] bool failed() const noexcept { return writer_failed_.load(); }
+
+        [[nodiscard]] std::vector<writer::ConnectionStats> connectionStats() const {
+            return quest_db_writer_->connectionStats();
+        }
     };
 }
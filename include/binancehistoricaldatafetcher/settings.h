@@ -9,6 +9,7 @@
 #include <optional>
 #include <vector>
 #include "common/models/enums.h"
+#include "common/sync/wait_strategy.h"
 
 namespace binance::settings {
 
@@ -21,7 +22,30 @@ namespace binance::settings {
         DownloadType downloadType;
         OutputType outputType;
         DataType dataType;
-        int batchSize;
+        size_t flushBytes{1024 * 1024};
+        int flushLatencyMs{2000};
+        bool autoTuneFlush{false};
+        std::optional<std::string> spoolDir;
+        uint64_t spoolMaxBytes{0};
+        size_t parallelism{1};
+        size_t parseThreads{1};
+        size_t parseWorkers{1};
+        size_t prefetch{1};
+        size_t batchRows{4096};
+        size_t queueBlocks{256};
+        size_t flushesInFlight{2};
+        size_t writerConnections{1};
+        common::sync::WaitPolicy waitPolicy{common::sync::WaitPolicy::SPIN_PARK};
+        bool streaming{false};
+        bool dryRun{false};
+        std::optional<std::string> manifestPath;
+        bool resume{false};
+        std::optional<std::string> referenceDataPath;
+        std::optional<std::string> cacheDir;
+        uint64_t cacheMaxBytes{0};
+        int maxAttempts{6};
+        uint64_t rangeSplitBytes{0};
+        size_t rangeConnections{1};
         std::optional<std::string> dbUrl; // Only for QuestDB
         std::optional<std::string> outputDir; // Only for Parquet
         std::optional<CandleFrequency> candleFrequency;
@@ -0,0 +1,35 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// forward declare to keep openssl out of the public headers
+struct evp_md_ctx_st;
+
+namespace common::crypto {
+
+    // Incremental SHA-256 backed by OpenSSL's EVP interface, which picks the SHA-NI / AVX2
+    // implementation at runtime and comfortably outruns disk and network throughput.
+    class Sha256 {
+        evp_md_ctx_st *ctx_;
+
+    public:
+        Sha256();
+        ~Sha256();
+
+        Sha256(const Sha256 &) = delete;
+        Sha256 &operator=(const Sha256 &) = delete;
+
+        void update(std::string_view data);
+
+        // lower case hex digest; the hasher is reset and can be reused afterwards
+        [[nodiscard]] std::string hex_digest();
+
+        [[nodiscard]] static std::string hash_file(const std::filesystem::path &path);
+    };
+}
@@ -0,0 +1,75 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "common/models/common_data_models.h"
+#include "common/reference/reference_data_service.h"
+#include "common/rounding/fixed_point.h"
+
+namespace common::io {
+
+    // Notional and volume weighted average price over the levels of one snapshot side. notional is a mantissa
+    // at the symbol's notional_codec scale, the same one trade quote_qty carries, vwap one at its price_codec scale.
+    struct DepthVwap {
+        models::types::Price notional;
+        models::types::Price vwap;
+    };
+
+    // price_codec and quantity_codec scales up to this many digits each, every exchange precision Binance lists
+    constexpr int MAX_DEPTH_VWAP_PRECISION = reference::ARCHIVE_PRECISION;
+
+    namespace detail {
+
+        using DepthVwapFn = std::optional<DepthVwap> (*)(const models::PriceLevel *, size_t) noexcept;
+
+        template<int PriceScale, int QuantityScale>
+        std::optional<DepthVwap> depth_vwap_at(const models::PriceLevel *levels, const size_t count) noexcept {
+            using rounding::FixedPoint;
+            constexpr int NOTIONAL_SCALE = std::max(PriceScale + QuantityScale, reference::ARCHIVE_PRECISION);
+            rounding::Vwap<models::types::Price, PriceScale, QuantityScale> vwap;
+            try {
+                for (size_t i = 0; i < count; ++i) {
+                    vwap.add(FixedPoint<models::types::Price, PriceScale>::from_raw(levels[i].price),
+                             FixedPoint<models::types::Quantity, QuantityScale>::from_raw(levels[i].quantity));
+                }
+                if (vwap.quantity().raw() == 0) {
+                    return std::nullopt;
+                }
+                return DepthVwap{vwap.notional().template rescale<NOTIONAL_SCALE>().raw(), vwap.value().raw()};
+            } catch (const std::exception &) {
+                // overflowed a Price, the caller leaves the columns out
+                return std::nullopt;
+            }
+        }
+
+        template<int... Index>
+        constexpr auto make_depth_vwaps(std::integer_sequence<int, Index...>) {
+            constexpr int SCALES = MAX_DEPTH_VWAP_PRECISION + 1;
+            return std::array<DepthVwapFn, sizeof...(Index)>{&depth_vwap_at<Index / SCALES, Index % SCALES>...};
+        }
+
+        // indexed by price scale * (MAX_DEPTH_VWAP_PRECISION + 1) + quantity scale
+        constexpr auto DEPTH_VWAPS = make_depth_vwaps(
+            std::make_integer_sequence<int, (MAX_DEPTH_VWAP_PRECISION + 1) * (MAX_DEPTH_VWAP_PRECISION + 1)>{});
+    }
+
+    // Dispatches once on the run time price / quantity precisions to the Vwap instantiated for them. Empty when
+    // the side is empty, a precision is above MAX_DEPTH_VWAP_PRECISION or the notional does not fit a Price.
+    inline std::optional<DepthVwap> depth_vwap(const models::PriceLevel *levels, const size_t count,
+                                               const int price_precision, const int quantity_precision) noexcept {
+        if (price_precision < 0 || price_precision > MAX_DEPTH_VWAP_PRECISION
+            || quantity_precision < 0 || quantity_precision > MAX_DEPTH_VWAP_PRECISION) {
+            return std::nullopt;
+        }
+        return detail::DEPTH_VWAPS[price_precision * (MAX_DEPTH_VWAP_PRECISION + 1) + quantity_precision](levels, count);
+    }
+}
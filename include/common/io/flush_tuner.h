@@ -0,0 +1,103 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace common::io {
+
+    constexpr size_t DEFAULT_FLUSH_BYTES = 1024 * 1024;
+    constexpr size_t MIN_FLUSH_BYTES = 16 * 1024;
+    // stays below the 100 MiB QuestDB accepts per HTTP request by default
+    constexpr size_t MAX_FLUSH_BYTES = 64 * 1024 * 1024;
+    // flushes averaged per step, a single round trip is too noisy to steer by
+    constexpr size_t FLUSH_TUNER_WINDOW = 8;
+
+    struct FlushBudget {
+        // a buffer is flushed once its encoded rows reach this many bytes
+        size_t bytes{DEFAULT_FLUSH_BYTES};
+        // let the target follow the observed flushes, within [minBytes, maxBytes]
+        bool autoTune{false};
+        size_t minBytes{MIN_FLUSH_BYTES};
+        size_t maxBytes{MAX_FLUSH_BYTES};
+    };
+
+    // The flush size target of one connection. Without auto tuning it is the fixed budget.
+    //
+    // With it, the target hill climbs on throughput: bytes acknowledged per second spent in flush calls
+    // (ILP over HTTP only returns once the server acknowledged the rows). Small requests are dominated
+    // by the round trip, so growing them pays until the server itself becomes the limit. Past that knee
+    // a bigger request only adds latency, so a flat window turns the climb around and the target settles
+    // oscillating one step around the knee. A window whose mean flush exceeds maxLatency always shrinks.
+    //
+    // observe() is called by the flusher thread only, target() by any thread.
+    class FlushTuner {
+        using clock = std::chrono::steady_clock;
+
+        static constexpr double STEP = 1.25;
+        // relative throughput change below which a step counts as flat
+        static constexpr double SIGNIFICANT = 0.05;
+
+        const FlushBudget budget_;
+        const clock::duration maxLatency_;
+        std::atomic<size_t> target_;
+
+        uint64_t windowBytes_{0};
+        clock::duration windowTime_{0};
+        size_t windowFlushes_{0};
+        double lastThroughput_{0.0};
+        bool growing_{true};
+
+    public:
+        FlushTuner(const FlushBudget &budget, const clock::duration maxLatency) :
+            budget_(budget),
+            maxLatency_(maxLatency),
+            target_(budget.autoTune ? std::clamp(budget.bytes, budget.minBytes, budget.maxBytes) : budget.bytes) {}
+
+        FlushTuner(const FlushTuner &) = delete;
+        FlushTuner &operator=(const FlushTuner &) = delete;
+
+        [[nodiscard]] size_t target() const noexcept {
+            return target_.load(std::memory_order_relaxed);
+        }
+
+        // one acknowledged flush of bytes that took latency
+        void observe(const size_t bytes, const clock::duration latency) {
+            if (!budget_.autoTune) {
+                return;
+            }
+            windowBytes_ += bytes;
+            windowTime_ += latency;
+            if (++windowFlushes_ < FLUSH_TUNER_WINDOW) {
+                return;
+            }
+            const double seconds = std::chrono::duration<double>(windowTime_).count();
+            const double throughput = seconds > 0.0 ? static_cast<double>(windowBytes_) / seconds : 0.0;
+            if (windowTime_ / windowFlushes_ > maxLatency_) {
+                growing_ = false;
+            } else if (lastThroughput_ > 0.0) {
+                const double gain = (throughput - lastThroughput_) / lastThroughput_;
+                if (gain < -SIGNIFICANT) {
+                    // the last step hurt, undo it
+                    growing_ = !growing_;
+                } else if (gain < SIGNIFICANT) {
+                    growing_ = false;
+                }
+            }
+            const double target = static_cast<double>(target_.load(std::memory_order_relaxed));
+            const double next = growing_ ? target * STEP : target / STEP;
+            target_.store(std::clamp(static_cast<size_t>(next), budget_.minBytes, budget_.maxBytes), std::memory_order_relaxed);
+
+            lastThroughput_ = throughput;
+            windowBytes_ = 0;
+            windowTime_ = clock::duration::zero();
+            windowFlushes_ = 0;
+        }
+    };
+}
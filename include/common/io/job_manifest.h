@@ -0,0 +1,65 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace common::io {
+
+    constexpr size_t DEFAULT_MANIFEST_BATCH_SIZE = 64;
+
+    // progress of a single download unit, ordered - a unit only ever moves forward
+    enum class UnitState : uint8_t {
+        PLANNED,
+        DOWNLOADED,
+        PARSED,
+        FLUSHED, // every row was flushed to the sink and acknowledged by the writer
+    };
+
+    [[nodiscard]] std::string_view unit_state_name(UnitState state);
+
+    // Append-only, crash safe record of which units of a backfill job are done.
+    //
+    // Each transition is one "<STATE> <key>\n" line. Replaying the file keeps the furthest state per key,
+    // and a torn last line from a crash mid-write is ignored. Transitions are buffered and written with
+    // a single write + fsync once batch_size of them are pending or when sync() is called, so the cost
+    // is one fsync per batch rather than per unit.
+    class JobManifest {
+        const std::filesystem::path path_;
+        const size_t batch_size_;
+        int fd_{-1};
+        std::unordered_map<std::string, UnitState> states_;
+        std::vector<std::string> pending_;
+        mutable std::mutex mutex_;
+
+    public:
+        // resume = false starts a new job and truncates any previous manifest at path
+        JobManifest(const std::filesystem::path &path, bool resume, size_t batch_size = DEFAULT_MANIFEST_BATCH_SIZE);
+        ~JobManifest();
+
+        JobManifest(const JobManifest &) = delete;
+        JobManifest &operator=(const JobManifest &) = delete;
+
+        void record(const std::string &key, UnitState state);
+
+        // writes and fsyncs everything recorded so far
+        void sync();
+
+        [[nodiscard]] std::optional<UnitState> state(const std::string &key) const;
+
+        [[nodiscard]] bool is_complete(const std::string &key) const;
+
+    private:
+        void load();
+        void write_pending();
+    };
+}
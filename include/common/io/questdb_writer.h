@@ -7,13 +7,31 @@
 #include <string>
 #include <memory>
 #include <chrono>
+#include <array>
 #include <atomic>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
 #include "libs/concurrentqueue/concurrentqueue.h"
 #include <questdb/ingress/line_sender.hpp>
 
 #include "binancehistoricaldatafetcher/file_downloader.h"
 #include "writer.h"
+#include "depth_vwap.h"
+#include "flush_tuner.h"
+#include "scale_levels.h"
+#include "spool.h"
+#include "symbol_shards.h"
+#include "job_manifest.h"
+#include "common/sync/blocking_queue.h"
+#include "common/sync/bounded_queue.h"
+#include "common/sync/stage_stats.h"
+#include "common/sync/wait_strategy.h"
 #include "common/models/enums.h"
+#include "common/reference/reference_data_service.h"
 #include "common/rounding/fixed_point.h"
 
 
@@ -32,10 +50,40 @@ namespace writer {
     constexpr auto SNAPSHOTS_COL_BIDS = "bids";
     constexpr auto SNAPSHOTS_COL_ASKS = "asks";
     constexpr auto SNAPSHOTS_PRODUCT_TYPE = "product_type";
+    // events taken off the queue per bulk dequeue
+    constexpr size_t WRITER_DEQUEUE_BULK = 64;
+    // encoded buffers allowed to wait for or be in an HTTP flush while the next one is encoded
+    constexpr size_t DEFAULT_FLUSHES_IN_FLIGHT = 2;
+    // ILP connections rows are spread over, by symbol
+    constexpr size_t DEFAULT_WRITER_CONNECTIONS = 1;
+    // while batches are spooled, how often the sink is probed by replaying the oldest one
+    constexpr auto SPOOL_REPLAY_INTERVAL = std::chrono::seconds(1);
+    constexpr auto SPOOL_REPLAY_TIMEOUT = std::chrono::seconds(10);
+    // spooled batches replayed before the flusher looks at its queue again
+    constexpr size_t SPOOL_REPLAY_BATCH = 16;
+
+    // where batches go while QuestDB is unreachable, one sub directory per connection. A connection only
+    // replays its own directory, so a spool still holding batches refuses to open with another count.
+    struct SpoolOptions {
+        std::filesystem::path dir;
+        uint64_t maxBytes{common::io::DEFAULT_SPOOL_MAX_BYTES};
+    };
+
+    // cumulative since start, per connection
+    struct ConnectionStats {
+        uint64_t rows;
+        uint64_t bytes;
+        // current flush size target, moves only with auto tuning
+        size_t flushBytes;
+        // all zero without a spool
+        common::io::SpoolStats spool;
+    };
 
+    // a depth x 2 (price, quantity) array; data is sized for the deepest book seen so far and only
+    // the first shape[0] * 2 values belong to the current snapshot
     struct tensor {
         std::vector<double> data;
-        std::vector<uintptr_t> shape;
+        std::array<uintptr_t, 2> shape{0, 2};
     };
 
     inline auto to_array_view_state_impl(const tensor& t) {
@@ -43,57 +91,113 @@ namespace writer {
             t.shape.size(),
             t.shape.data(),
             t.data.data(),
-            t.data.size(),
+            t.shape[0] * t.shape[1],
         };
     }
 
-    inline tensor to_tensor(const std::vector<PriceLevel> &price_levels, const int tick_size, const int step_size) {
-        // price level is a price and a volume as a double
-        // so two columns, n rows
-        //  would be the number of price levels - so the length of the vector
-        [[likely]] if (size_t size = price_levels.size(); size > 0) {
-            tensor t;
-            t.shape = {size, 2};
-            t.data.reserve(size * 2);
-            for (const auto &[price, quantity] : price_levels) {
-                auto price_double = common::rounding::FixedPoint::to_double(price, tick_size);
-                auto quantity_double = common::rounding::FixedPoint::to_double(quantity, step_size);
-                t.data.push_back(price_double);
-                t.data.push_back(quantity_double);
-            }
-            return t;
+    inline void to_tensor(const std::vector<PriceLevel> &price_levels, const common::reference::PriceCodec &price_codec,
+                          const common::reference::PriceCodec &quantity_codec, tensor &t) {
+        // grows to the deepest book once, every later snapshot reuses the storage
+        if (t.data.size() < price_levels.size() * 2) {
+            t.data.resize(price_levels.size() * 2);
         }
-        return tensor{};
+        t.shape[0] = price_levels.size();
+        common::io::scale_levels(price_levels.data(), price_levels.size(), price_codec.divisor, quantity_codec.divisor, t.data.data());
     }
 
+    // scratch tensors of one symbol's snapshots
+    struct SnapshotTensors {
+        tensor bids;
+        tensor asks;
+    };
+
     class QuestDBWriter final : IWriter {
-        moodycamel::ConcurrentQueue<DataEvent> &buffer_;
+        common::sync::BoundedQueue<DataEvent> &buffer_;
         std::string dbConnectionURI;
-        int batchSize_{};
-        questdb::ingress::line_sender dbSender;
         int flushIntervalMs_;
         const std::shared_ptr<common::sync::producer_consumer::Context> context_;
         std::atomic<int> eventsWritten_{0};
         DataType dataType_;
-        questdb::ingress::line_sender_buffer dbBuffer_;
+        // longest rows wait in a buffer that has not reached its byte budget
         milliseconds flushInterval_;
-        const std::shared_ptr<std::unordered_map<std::string, ExchangeInfo>> exchangeInfo_;
-        const common::rounding::FixedPoint rounder_{};
+        const std::shared_ptr<const common::reference::ReferenceDataService> referenceData_;
+        const std::shared_ptr<common::io::JobManifest> manifest_;
+        common::sync::StageStats stats_{"write"};
+        std::vector<DataEvent> drained_;
+        // indexed by symbol id, encoding a snapshot allocates nothing once its symbol's book depth was seen
+        std::vector<SnapshotTensors> snapshotTensors_;
+        moodycamel::ConsumerToken consumerToken_;
+        common::sync::WaitStrategy wait_;
+
+        // an encoded buffer and the units it completes, acked only once the buffer is in QuestDB
+        struct FlushBatch {
+            questdb::ingress::line_sender_buffer buffer;
+            size_t rows{0};
+            // units whose completion markers were dequeued but whose rows are not flushed yet
+            std::vector<std::string> acks;
+        };
+
+        // One ILP connection with its own flusher thread. A symbol always maps to the same connection,
+        // so its rows keep their timestamp order and its completion marker follows its rows.
+        struct Connection {
+            questdb::ingress::line_sender sender;
+            // being encoded on the writer thread
+            FlushBatch current;
+            // encoded batches on their way to the flusher thread, and emptied buffers on their way back.
+            // The writer blocks on spareBuffers once flushesInFlight batches are outstanding.
+            common::sync::BlockingQueue<FlushBatch> flushQueue;
+            common::sync::BlockingQueue<FlushBatch> spareBuffers;
+            std::atomic<uint64_t> rowsFlushed{0};
+            std::atomic<uint64_t> bytesFlushed{0};
+            common::io::FlushTuner tuner;
+            // batches that could not be flushed, in order - while it holds any, new batches queue up behind
+            std::unique_ptr<common::io::Spool> spool;
+            steady_clock::time_point nextReplay{};
+            std::thread flusher;
+
+            Connection(const std::string &uri, size_t flushesInFlight, const common::io::FlushBudget &budget,
+                       steady_clock::duration maxLatency);
+        };
+
+        // the HTTP endpoint spooled batches are posted to, taken from the connection string
+        struct ReplayTarget {
+            std::string url;
+            std::string username;
+            std::string password;
+            std::string token;
+            bool verifyTls{true};
+        };
+
+        std::vector<std::unique_ptr<Connection>> connections_;
+        ReplayTarget replayTarget_;
+        std::mutex flushErrorMutex_;
+        std::exception_ptr flushError_;
 
     public:
 
-        explicit QuestDBWriter(moodycamel::ConcurrentQueue<DataEvent> &buffer,
+        explicit QuestDBWriter(common::sync::BoundedQueue<DataEvent> &buffer,
             const std::string &dbConnectionURI,
             const std::shared_ptr<common::sync::producer_consumer::Context> &context,
-            const std::shared_ptr<std::unordered_map<std::string, ExchangeInfo>> &exchangeInfo,
-            int batchSize = 1000,
+            const std::shared_ptr<const common::reference::ReferenceDataService> &referenceData,
+            const common::io::FlushBudget &flushBudget = {},
             int flushIntervalMs = 1000,
-            DataType dataType = common::models::enums::TRADES);
+            DataType dataType = common::models::enums::TRADES,
+            const std::shared_ptr<common::io::JobManifest> &manifest = nullptr,
+            const common::sync::WaitOptions &wait = {},
+            size_t flushesInFlight = DEFAULT_FLUSHES_IN_FLIGHT,
+            size_t connections = DEFAULT_WRITER_CONNECTIONS,
+            const std::optional<SpoolOptions> &spool = std::nullopt);
+
+        ~QuestDBWriter() override;
 
         void write() override;
 
         void close() override;
 
+        [[nodiscard]] const common::sync::StageStats &stats() const { return stats_; }
+        [[nodiscard]] const common::sync::BoundedQueue<DataEvent> &queue() const { return buffer_; }
+        [[nodiscard]] std::vector<ConnectionStats> connectionStats() const;
+
     private:
         void incrementEventsWritten(const int count) {
             eventsWritten_ += count;
@@ -107,8 +211,28 @@ namespace writer {
             return eventsWritten_;
         }
 
-        void writeTradeToDbBuffer(const Trade& trade_event);
-        void writeCandleToDbBuffer(const Candle& candle_event);
-        void writeOrderbookToDbBuffer(const OrderbookSnapshot& orderbook_event);
+        Connection &connectionFor(const types::Symbol symbol) {
+            return *connections_[common::io::shard_for(symbol, connections_.size())];
+        }
+
+        // hands every encoded buffer to its flusher and returns the time spent waiting for spare ones
+        steady_clock::duration flush();
+        steady_clock::duration flush(Connection &connection);
+        void runFlusher(Connection &connection);
+        // flushes a batch, or spools it if the sink is unreachable or a backlog is already spooled
+        void send(Connection &connection, FlushBatch &batch);
+        void spoolBatch(Connection &connection, const FlushBatch &batch);
+        // replays the oldest spooled batches, returns how long to wait before trying again
+        steady_clock::duration replaySpool(Connection &connection);
+        void ackUnits(const std::vector<std::string> &units);
+        void stopFlushers();
+        void rethrowFlushError();
+
+        // encodes one event and flushes its connection once the buffer reaches the byte budget,
+        // returns the time spent waiting for a spare buffer
+        steady_clock::duration writeEvent(DataEvent& event);
+        void writeTradesToDbBuffer(questdb::ingress::line_sender_buffer &buffer, const TradeBatch& trades);
+        void writeCandlesToDbBuffer(questdb::ingress::line_sender_buffer &buffer, const CandleBatch& candles);
+        void writeOrderbookToDbBuffer(questdb::ingress::line_sender_buffer &buffer, const OrderbookSnapshot& orderbook_event);
     };
 }
@@ -0,0 +1,26 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/models/common_data_models.h"
+
+namespace common::io {
+
+    // Writes levels[i].price / price_divisor and levels[i].quantity / quantity_divisor to out[2i] and
+    // out[2i + 1], the same values DecimalCodec::to_double gives.
+    //
+    // The two divisions per level bound this loop, not the int64 -> double conversion: converting
+    // through the bits of 1.5 * 2^52 instead of the cast measured no faster at depth 20 to 1000, see
+    // bench/scale_levels_bench. So it stays a plain cast, which matches to_double over the whole int64 range.
+    inline void scale_levels(const common::models::PriceLevel *levels, const size_t count, const double price_divisor,
+                             const double quantity_divisor, double *out) {
+        for (size_t i = 0; i < count; ++i) {
+            out[2 * i] = static_cast<double>(levels[i].price) / price_divisor;
+            out[2 * i + 1] = static_cast<double>(levels[i].quantity) / quantity_divisor;
+        }
+    }
+}
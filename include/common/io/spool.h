@@ -0,0 +1,98 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+namespace common::io {
+
+    constexpr size_t DEFAULT_SPOOL_SEGMENT_BYTES = 64 * 1024 * 1024;
+    constexpr uint64_t DEFAULT_SPOOL_MAX_BYTES = 4ULL * 1024 * 1024 * 1024;
+
+    struct SpoolStats {
+        uint64_t records;    // waiting for replay
+        uint64_t bytes;      // payload bytes waiting for replay
+        uint64_t diskBytes;  // segment files on disk
+        uint64_t spooled;    // cumulative
+        uint64_t replayed;
+        uint64_t dropped;    // refused by the disk budget
+    };
+
+    struct SpoolRecord {
+        std::string_view payload;
+        // opaque to the spool, e.g. what to acknowledge once the payload is delivered
+        std::string_view meta;
+    };
+
+    // Append-only FIFO of byte records on local disk, for data that has to outlive an unreachable sink.
+    //
+    // Records go into memory mapped segment files of segmentBytes each (larger records get a segment of
+    // their own). Every record carries a crc32 and a consumed flag that pop() sets in place, so after a
+    // restart the files are replayed from the first record that was not consumed. A crash of the process
+    // loses nothing the kernel already has, a torn record at the tail after a power loss fails its
+    // checksum and ends the replay of its segment. Fully consumed segments are deleted.
+    //
+    // Disk usage is bounded by maxBytes: once the segments would exceed it, append() refuses the record.
+    // Not thread safe - one thread appends and pops, stats() may be read from anywhere.
+    class Spool {
+        struct Segment {
+            uint64_t sequence;
+            int fd;
+            std::byte *data;
+            size_t size;
+            size_t writeOffset;
+            size_t readOffset;
+            // recovered segments are only read, appends start a new one
+            bool sealed;
+        };
+
+        const std::filesystem::path dir_;
+        const uint64_t maxBytes_;
+        const size_t segmentBytes_;
+        // oldest first, appends go to the back
+        std::deque<Segment> segments_;
+        uint64_t nextSequence_{0};
+
+        std::atomic<uint64_t> records_{0};
+        std::atomic<uint64_t> bytes_{0};
+        std::atomic<uint64_t> diskBytes_{0};
+        std::atomic<uint64_t> spooled_{0};
+        std::atomic<uint64_t> replayed_{0};
+        std::atomic<uint64_t> dropped_{0};
+
+    public:
+        Spool(const std::filesystem::path &dir, uint64_t maxBytes = DEFAULT_SPOOL_MAX_BYTES,
+              size_t segmentBytes = DEFAULT_SPOOL_SEGMENT_BYTES);
+        ~Spool();
+
+        Spool(const Spool &) = delete;
+        Spool &operator=(const Spool &) = delete;
+
+        // false if the record does not fit the disk budget, it is counted as dropped then
+        bool append(std::string_view payload, std::string_view meta = {});
+
+        // the oldest record not consumed yet, its views stay valid until pop()
+        [[nodiscard]] std::optional<SpoolRecord> front();
+
+        // marks the front record consumed
+        void pop();
+
+        [[nodiscard]] bool empty() const noexcept { return records_.load(std::memory_order_relaxed) == 0; }
+
+        [[nodiscard]] SpoolStats stats() const noexcept;
+
+    private:
+        void recover();
+        Segment &openSegment(uint64_t sequence, size_t size, bool create);
+        void removeFront();
+        [[nodiscard]] std::filesystem::path segmentPath(uint64_t sequence) const;
+    };
+}
@@ -0,0 +1,19 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/models/types.h"
+
+namespace common::io {
+
+    // The connection a symbol's rows are written on, out of connections > 0. A symbol never moves, so
+    // its rows keep the order they were queued in and its completion marker follows them. Symbol ids
+    // are dense, so consecutive ids spread evenly.
+    [[nodiscard]] constexpr size_t shard_for(const common::models::types::Symbol symbol, const size_t connections) noexcept {
+        return symbol % connections;
+    }
+}
@@ -0,0 +1,72 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <zlib.h>
+
+namespace common::io {
+
+    constexpr size_t DEFAULT_INFLATE_CHUNK_SIZE = 256 * 1024;
+
+    // Incrementally inflates the first entry of a zip archive as its bytes arrive.
+    // Only the local file header is needed, so the archive never has to be on disk -
+    // Binance archives hold a single csv, anything after the first entry is ignored.
+    class ZipInflateStream {
+    public:
+        using Sink = std::function<void(std::string_view)>;
+
+        explicit ZipInflateStream(Sink sink, size_t chunk_size = DEFAULT_INFLATE_CHUNK_SIZE);
+        ~ZipInflateStream();
+
+        ZipInflateStream(const ZipInflateStream &) = delete;
+        ZipInflateStream &operator=(const ZipInflateStream &) = delete;
+
+        // returns false once the input is known to be corrupt - callers should abort the transfer
+        [[nodiscard]] bool feed(std::string_view bytes);
+
+        // true if the entry was fully inflated and its crc matches
+        [[nodiscard]] bool finish();
+
+        [[nodiscard]] const std::string &error() const { return error_; }
+        [[nodiscard]] uint64_t bytes_in() const { return bytes_in_; }
+        [[nodiscard]] uint64_t bytes_out() const { return bytes_out_; }
+
+    private:
+        enum class State {
+            HEADER,
+            DATA,
+            TRAILER,
+            DONE,
+            ERROR,
+        };
+
+        bool parse_header(std::string_view &bytes);
+        bool inflate_data(std::string_view &bytes);
+        bool copy_stored(std::string_view &bytes);
+        void emit(const char *data, size_t len);
+        bool fail(std::string message);
+
+        Sink sink_;
+        State state_{State::HEADER};
+        z_stream zs_{};
+        bool zs_initialised_{false};
+        std::vector<char> out_;
+        std::string header_;
+        std::string trailer_;
+        std::string error_;
+        uint16_t flags_{0};
+        uint16_t method_{0};
+        uint32_t expected_crc_{0};
+        uint64_t stored_remaining_{0};
+        uint32_t crc_{0};
+        uint64_t bytes_in_{0};
+        uint64_t bytes_out_{0};
+    };
+}
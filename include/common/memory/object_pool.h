@@ -0,0 +1,117 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <concurrentqueue/concurrentqueue.h>
+
+namespace common::memory {
+
+    template<typename T>
+    class ObjectPool;
+
+    // Sends the object back to its pool; without a pool (converted from a plain unique_ptr) it deletes.
+    template<typename T>
+    struct PoolDeleter {
+        ObjectPool<T> *pool{nullptr};
+
+        PoolDeleter() = default;
+        explicit PoolDeleter(ObjectPool<T> *owner) noexcept : pool(owner) {}
+        PoolDeleter(std::default_delete<T>) noexcept {}
+
+        void operator()(T *object) const noexcept {
+            if (pool != nullptr) {
+                pool->release(object);
+            } else {
+                delete object;
+            }
+        }
+    };
+
+    template<typename T>
+    using Pooled = std::unique_ptr<T, PoolDeleter<T>>;
+
+    // Recycles heap objects so steady state traffic allocates none of them, members like vectors keep their
+    // capacity between uses. Objects come back exactly as they were released - acquirers overwrite them.
+    //
+    // Meant to be owned by one producer thread that acquires, while consumers release on whichever thread
+    // they run: the free list is a lock free queue. Every outstanding object holds a reference, so the pool
+    // outlives its owner until the last object is back and handles left in queues stay valid.
+    template<typename T>
+    class ObjectPool {
+        using Init = void (*)(T &);
+
+        moodycamel::ConcurrentQueue<T *> free_;
+        std::atomic<size_t> refs_{1};
+        std::atomic<uint64_t> allocations_{0};
+        const Init init_;
+
+        ObjectPool(const size_t prewarm, const Init init) : free_(prewarm), init_(init) {
+            for (size_t i = 0; i < prewarm; ++i) {
+                free_.enqueue(allocate());
+            }
+        }
+
+        ~ObjectPool() {
+            T *object;
+            while (free_.try_dequeue(object)) {
+                delete object;
+            }
+        }
+
+        T *allocate() {
+            auto *object = new T();
+            if (init_ != nullptr) {
+                init_(*object);
+            }
+            allocations_.fetch_add(1, std::memory_order_relaxed);
+            return object;
+        }
+
+        void unref() noexcept {
+            if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete this;
+            }
+        }
+
+    public:
+        struct Closer {
+            void operator()(ObjectPool *pool) const noexcept { pool->unref(); }
+        };
+        using Owner = std::unique_ptr<ObjectPool, Closer>;
+
+        // prewarm objects are allocated up front, init runs once per fresh object (e.g. to reserve vectors)
+        static Owner create(const size_t prewarm = 0, const Init init = nullptr) {
+            return Owner(new ObjectPool(prewarm, init));
+        }
+
+        ObjectPool(const ObjectPool &) = delete;
+        ObjectPool &operator=(const ObjectPool &) = delete;
+
+        [[nodiscard]] Pooled<T> acquire() {
+            T *object;
+            if (!free_.try_dequeue(object)) {
+                object = allocate();
+            }
+            refs_.fetch_add(1, std::memory_order_relaxed);
+            return Pooled<T>(object, PoolDeleter<T>(this));
+        }
+
+        void release(T *object) noexcept {
+            if (!free_.enqueue(object)) {
+                delete object;
+            }
+            unref();
+        }
+
+        // pooled objects allocated so far, prewarm included - flat once the pool has warmed up. Allocations
+        // made by whoever fills them are not counted
+        [[nodiscard]] uint64_t allocations() const noexcept {
+            return allocations_.load(std::memory_order_relaxed);
+        }
+    };
+}
@@ -3,26 +3,31 @@
 //
 #pragma once
 
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <variant>
 #include <vector>
 #include <optional>
 #include <nlohmann/json.hpp>
 
+#include "common/memory/object_pool.h"
 #include "common/rounding/fixed_point.h"
 #include "common/models/enums.h"
+#include "common/models/types.h"
+#include "common/reference/reference_data_service.h"
 
 namespace common::models {
 
     struct PriceLevel {
-        std::int32_t price;
-        std::int32_t quantity;
+        types::Price price;
+        types::Quantity quantity;
     };
 
     inline void from_json(const nlohmann::json &j, PriceLevel &p, const int price_precision, const int quantity_precision) {
-        if (j.is_array() && j.size() == 2) {
-            p.price = rounding::FixedPoint::from_string(j.at(0).get<std::string>(), price_precision);
-            p.quantity = rounding::FixedPoint::from_string(j.at(1).get<std::string>(), quantity_precision);
-        } else {
+        if (!j.is_array() || j.size() != 2
+            || !rounding::decimal_codec<types::Price>(price_precision).parse(j[0].get_ref<const std::string &>(), p.price)
+            || !rounding::decimal_codec<types::Quantity>(quantity_precision).parse(j[1].get_ref<const std::string &>(), p.quantity)) {
             throw std::runtime_error("Invalid PriceLevel JSON format");
         }
     }
@@ -35,21 +40,18 @@ namespace common::models {
     }
 
 
-    struct ExchangeInfo {
-        int tick_size;
-        int step_size;
-    };
-
+    // one row of a trades archive; symbol and product live on the enclosing TradeBatch.
+    // price, qty and quote_qty are mantissas at the symbol's archive_price_codec, archive_quantity_codec
+    // and notional_codec scales (see reference::ReferenceDataService)
     struct Trade {
         int64_t id;
-        double price;
-        double qty;
-        double quote_qty;
+        int64_t price;
+        int64_t qty;
+        int64_t quote_qty;
         int64_t time;
         enums::Side side;
-        std::string symbol;
-        enums::Product product_type;
     };
+    static_assert(std::is_trivially_copyable_v<Trade>);
 
     inline void to_json(nlohmann::json &j, const Trade &t) {
         j = {
@@ -58,64 +60,224 @@ namespace common::models {
             {"qty", t.qty},
             {"quote_qty", t.quote_qty},
             {"time", t.time},
-            {"side", sideToString(t.side)},
-            {"symbol", t.symbol},
-            {"product_type", t.product_type}
+            {"side", sideToString(t.side)}
         };
     }
 
-
+    // one row of a klines archive; symbol, product and frequency live on the enclosing CandleBatch.
+    // prices are mantissas at the symbol's archive_price_codec scale, volume at its archive_quantity_codec
     struct Candle {
         int64_t open_time;
-        double open;
-        double high;
-        double low;
-        double close;
-        double volume;
+        int64_t open;
+        int64_t high;
+        int64_t low;
+        int64_t close;
+        int64_t volume;
         int64_t close_time;
-        std::string symbol;
+    };
+    static_assert(std::is_trivially_copyable_v<Candle>);
+
+    inline void to_json(nlohmann::json &j, const Candle &c) {
+        j = {
+            {"open_time", c.open_time},
+            {"open", c.open},
+            {"high", c.high},
+            {"low", c.low},
+            {"close", c.close},
+            {"volume", c.volume},
+            {"close_time", c.close_time}
+        };
+    }
+
+    // Trades of a single symbol stored column wise, so the writer walks contiguous arrays
+    // and the queue moves one pointer per few thousand rows.
+    struct TradeBatch {
+        types::Symbol symbol;
+        enums::Product product_type;
+        std::vector<int64_t> id;
+        std::vector<int64_t> price;
+        std::vector<int64_t> qty;
+        std::vector<int64_t> quote_qty;
+        std::vector<int64_t> time;
+        std::vector<enums::Side> side;
+
+        [[nodiscard]] size_t size() const { return id.size(); }
+
+        void reserve(const size_t rows) {
+            id.reserve(rows);
+            price.reserve(rows);
+            qty.reserve(rows);
+            quote_qty.reserve(rows);
+            time.reserve(rows);
+            side.reserve(rows);
+        }
+
+        void push_back(const Trade &trade) {
+            id.push_back(trade.id);
+            price.push_back(trade.price);
+            qty.push_back(trade.qty);
+            quote_qty.push_back(trade.quote_qty);
+            time.push_back(trade.time);
+            side.push_back(trade.side);
+        }
+
+        [[nodiscard]] Trade operator[](const size_t i) const {
+            return Trade{id[i], price[i], qty[i], quote_qty[i], time[i], side[i]};
+        }
+    };
+
+    // batches and snapshots carry a Symbol id that means nothing outside this process, the serialisers
+    // take the name resolved through reference::ReferenceDataService so the wire keeps the symbol name
+    inline void to_json(nlohmann::json &j, const TradeBatch &batch, const std::string &symbol) {
+        auto rows = nlohmann::json::array();
+        for (size_t i = 0; i < batch.size(); ++i) {
+            rows.push_back(batch[i]);
+        }
+        j = {
+            {"symbol", symbol},
+            {"product_type", batch.product_type},
+            {"trades", std::move(rows)}
+        };
+    }
+
+    struct CandleBatch {
+        types::Symbol symbol;
         enums::Product product_type;
         enums::CandleFrequency frequency;
+        std::vector<int64_t> open_time;
+        std::vector<int64_t> open;
+        std::vector<int64_t> high;
+        std::vector<int64_t> low;
+        std::vector<int64_t> close;
+        std::vector<int64_t> volume;
+        std::vector<int64_t> close_time;
+
+        [[nodiscard]] size_t size() const { return open_time.size(); }
+
+        void reserve(const size_t rows) {
+            open_time.reserve(rows);
+            open.reserve(rows);
+            high.reserve(rows);
+            low.reserve(rows);
+            close.reserve(rows);
+            volume.reserve(rows);
+            close_time.reserve(rows);
+        }
+
+        void push_back(const Candle &candle) {
+            open_time.push_back(candle.open_time);
+            open.push_back(candle.open);
+            high.push_back(candle.high);
+            low.push_back(candle.low);
+            close.push_back(candle.close);
+            volume.push_back(candle.volume);
+            close_time.push_back(candle.close_time);
+        }
+
+        [[nodiscard]] Candle operator[](const size_t i) const {
+            return Candle{open_time[i], open[i], high[i], low[i], close[i], volume[i], close_time[i]};
+        }
     };
 
-    inline void to_json(nlohmann::json &j, const Candle &c) {}
+    inline void to_json(nlohmann::json &j, const CandleBatch &batch, const std::string &symbol) {
+        auto rows = nlohmann::json::array();
+        for (size_t i = 0; i < batch.size(); ++i) {
+            rows.push_back(batch[i]);
+        }
+        j = {
+            {"symbol", symbol},
+            {"product_type", batch.product_type},
+            {"frequency", batch.frequency},
+            {"candles", std::move(rows)}
+        };
+    }
 
     struct OrderbookSnapshot {
         long long snapshot_time;
-        std::string symbol;
+        types::Symbol symbol;
         enums::Product product_type;
         std::vector<PriceLevel> bids;
         std::vector<PriceLevel> asks;
     };
 
-    inline void to_json(nlohmann::json &j, const OrderbookSnapshot &snapshot) {
+    inline void to_json(nlohmann::json &j, const OrderbookSnapshot &snapshot, const std::string &symbol) {
         j = {
             {"snapshot_time", snapshot.snapshot_time},
-            {"symbol", snapshot.symbol},
+            {"symbol", symbol},
             {"product_type", snapshot.product_type},
             {"bids", snapshot.bids},
             {"asks", snapshot.asks}
         };
     }
 
-    struct DataEvent {
-        std::optional<Trade> futures_trade;
-        std::optional<Candle> candle;
-        std::optional<OrderbookSnapshot > orderbook_snapshot;
+    // job manifest key of a unit whose rows were all enqueued ahead of this marker
+    struct UnitComplete {
+        std::string key;
+        types::Symbol symbol;
     };
 
-    inline void to_json(nlohmann::json &j, const DataEvent &event) {
+    // order matches the alternatives of DataEvent::Payload
+    enum class EventType : uint8_t {
+        EMPTY,
+        TRADE_BATCH,
+        CANDLE_BATCH,
+        ORDERBOOK_SNAPSHOT,
+        UNIT_COMPLETE,
+    };
 
-        if (event.orderbook_snapshot.has_value()) {
-            j["snapshot"] = event.orderbook_snapshot.value();
-        }
+    // Tagged pointer event - moving one through a queue copies 24 bytes (the pointer, a pool for pooled
+    // snapshots, the tag) whatever it carries.
+    struct DataEvent {
+        using Payload = std::variant<
+            std::monostate,
+            std::unique_ptr<TradeBatch>,
+            std::unique_ptr<CandleBatch>,
+            // drawn from the book builder's pools on the live path, a plain unique_ptr converts
+            common::memory::Pooled<OrderbookSnapshot>,
+            std::unique_ptr<UnitComplete>>;
 
-        if (event.futures_trade.has_value()) {
-            j["futures_trade"] = event.futures_trade.value();
+        Payload payload;
+
+        DataEvent() = default;
+        explicit DataEvent(std::unique_ptr<TradeBatch> batch) : payload(std::move(batch)) {}
+        explicit DataEvent(std::unique_ptr<CandleBatch> batch) : payload(std::move(batch)) {}
+        explicit DataEvent(common::memory::Pooled<OrderbookSnapshot> snapshot) : payload(std::move(snapshot)) {}
+        explicit DataEvent(std::unique_ptr<UnitComplete> marker) : payload(std::move(marker)) {}
+
+        [[nodiscard]] EventType type() const { return static_cast<EventType>(payload.index()); }
+
+        // rows carried towards the sink, markers and empty events count as none
+        [[nodiscard]] size_t rows() const {
+            switch (type()) {
+                case EventType::TRADE_BATCH: return trades().size();
+                case EventType::CANDLE_BATCH: return candles().size();
+                case EventType::ORDERBOOK_SNAPSHOT: return 1;
+                default: return 0;
+            }
         }
 
-        if (event.candle.has_value()) {
-            j["candle"] = event.candle.value();
+        [[nodiscard]] TradeBatch &trades() const { return *std::get<std::unique_ptr<TradeBatch>>(payload); }
+        [[nodiscard]] CandleBatch &candles() const { return *std::get<std::unique_ptr<CandleBatch>>(payload); }
+        [[nodiscard]] OrderbookSnapshot &snapshot() const { return *std::get<common::memory::Pooled<OrderbookSnapshot>>(payload); }
+        [[nodiscard]] UnitComplete &unit_complete() const { return *std::get<std::unique_ptr<UnitComplete>>(payload); }
+    };
+
+    inline void to_json(nlohmann::json &j, const DataEvent &event, const reference::ReferenceDataService &reference_data) {
+        switch (event.type()) {
+            case EventType::TRADE_BATCH:
+                to_json(j["trades"], event.trades(), reference_data.name(event.trades().symbol));
+                break;
+            case EventType::CANDLE_BATCH:
+                to_json(j["candles"], event.candles(), reference_data.name(event.candles().symbol));
+                break;
+            case EventType::ORDERBOOK_SNAPSHOT:
+                to_json(j["snapshot"], event.snapshot(), reference_data.name(event.snapshot().symbol));
+                break;
+            case EventType::UNIT_COMPLETE:
+                j["unit_complete"] = event.unit_complete().key;
+                break;
+            case EventType::EMPTY:
+                break;
         }
     }
-}
\ No newline at end of file
+}
@@ -16,6 +16,7 @@ namespace common::models::enums {
     enum DownloadType {
         MONTHLY,
         DAILY,
+        AUTO, // monthly archives for whole months, daily archives for the edges
     };
 
     DownloadType getDownloadType(const std::string &downloadTypeName);
@@ -4,26 +4,34 @@
 
 #pragma once
 
-#include <map>
-#include <string>
+#include <algorithm>
+#include <optional>
+#include <vector>
 
 #include "orderbook.h"
+#include "types.h"
 
 namespace common::models {
+    // books indexed directly by the dense symbol id from the reference data service;
+    // slots of symbols that are not tracked stay empty
     class MultiSymbolOrderbook {
-        std::map<std::string, Orderbook> multi_symbol_orderbook_;
+        std::vector<std::optional<Orderbook>> multi_symbol_orderbook_;
 
     public:
-        explicit MultiSymbolOrderbook(const std::vector<std::string>& symbols) {
-            for (const auto& symbol : symbols) {
-                multi_symbol_orderbook_.emplace(symbol, Orderbook());
+        explicit MultiSymbolOrderbook(const std::vector<types::Symbol>& symbols) {
+            if (symbols.empty()) {
+                return;
+            }
+            multi_symbol_orderbook_.resize(static_cast<size_t>(*std::ranges::max_element(symbols)) + 1);
+            for (const auto symbol : symbols) {
+                multi_symbol_orderbook_[symbol].emplace();
             }
         }
 
         ~MultiSymbolOrderbook() = default;
 
 
-        std::tuple<PriceLevel, PriceLevel> get_top_of_book(const std::string &symbol) {
+        std::tuple<PriceLevel, PriceLevel> get_top_of_book(const types::Symbol symbol) {
             const auto book = get_book(symbol);
             if (book == nullptr) {
                 throw std::invalid_argument("Symbol not found in orderbook manager");
@@ -32,7 +40,7 @@ namespace common::models {
 
         }
 
-        std::tuple<std::vector<PriceLevel>, std::vector<PriceLevel>> get_levels(const std::string &symbol, const size_t depth) {
+        std::tuple<std::vector<PriceLevel>, std::vector<PriceLevel>> get_levels(const types::Symbol symbol, const size_t depth) {
 
             const auto book = get_book(symbol);
             if (book == nullptr) {
@@ -41,20 +49,26 @@ namespace common::models {
             return book->get_levels(depth);
         }
 
-        [[nodiscard]] bool has_book(const std::string &symbol) const {
-            const auto exists = multi_symbol_orderbook_.find(symbol);
-            return exists != multi_symbol_orderbook_.end();
+        void copy_levels(const types::Symbol symbol, const size_t depth, std::vector<PriceLevel> &bids, std::vector<PriceLevel> &asks) {
+            const auto book = get_book(symbol);
+            if (book == nullptr) {
+                throw std::invalid_argument("Symbol not found in orderbook manager");
+            }
+            book->copy_levels(depth, bids, asks);
         }
 
-        void remove_book(const std::string &symbol) {
-           const auto book = get_book(symbol);
-            if (book == nullptr) {
+        [[nodiscard]] bool has_book(const types::Symbol symbol) const {
+            return symbol < multi_symbol_orderbook_.size() && multi_symbol_orderbook_[symbol].has_value();
+        }
+
+        void remove_book(const types::Symbol symbol) {
+            if (!has_book(symbol)) {
                 return;
             }
-            multi_symbol_orderbook_.erase(symbol);
+            multi_symbol_orderbook_[symbol].reset();
         }
 
-        void update_price_level(const std::string &symbol, const PriceLevel price_level, const bool is_bid) {
+        void update_price_level(const types::Symbol symbol, const PriceLevel price_level, const bool is_bid) {
             const auto  book = get_book(symbol);
             if (book == nullptr) {
                 return;
@@ -68,7 +82,7 @@ namespace common::models {
             }
         }
 
-        void remove_price_level(const std::string &symbol, const PriceLevel &priceLevel, const bool is_bid) {
+        void remove_price_level(const types::Symbol symbol, const PriceLevel &priceLevel, const bool is_bid) {
             const auto book = get_book(symbol);
             if (book == nullptr) {
                 return;
@@ -80,11 +94,11 @@ namespace common::models {
         // I want to force users to use the public methods to access the orderbook
         // to ensure that the symbol exists and to control the editing and ownership of the orderbook
         // objects
-        Orderbook* get_book(const std::string &symbol) {
-            if (const auto exists = multi_symbol_orderbook_.find(symbol); exists != multi_symbol_orderbook_.end()) {
-                return &exists->second;
+        Orderbook* get_book(const types::Symbol symbol) {
+            [[unlikely]] if (!has_book(symbol)) {
+                return nullptr;
             }
-            return nullptr;
+            return &*multi_symbol_orderbook_[symbol];
         }
     };
-}
\ No newline at end of file
+}
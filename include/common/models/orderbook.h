@@ -14,20 +14,20 @@
 namespace common::models {
 
     struct BidComparator {
-        bool operator()(const int32_t a, const int32_t b) const {
+        bool operator()(const types::Price a, const types::Price b) const {
             return a > b; // Higher prices first
         }
     };
 
     struct AskComparator {
-        bool operator()(const int32_t a, const int32_t b) const {
+        bool operator()(const types::Price a, const types::Price b) const {
             return a < b; // Lower prices first
         }
     };
 
     class Orderbook {
-        std::pmr::map<std::int32_t, PriceLevel, BidComparator> bids_; // price -> quantity
-        std::pmr::map<std::int32_t, PriceLevel, AskComparator> asks_; // price -> quantity
+        std::pmr::map<types::Price, PriceLevel, BidComparator> bids_; // price -> quantity
+        std::pmr::map<types::Price, PriceLevel, AskComparator> asks_; // price -> quantity
 
     public:
         Orderbook() : bids_(
@@ -68,9 +68,14 @@ namespace common::models {
         // index 0 = bids, index 1 = asks
         [[nodiscard]] std::tuple<std::vector<PriceLevel>, std::vector<PriceLevel>> get_levels(const size_t depth) const {
             std::tuple<std::vector<PriceLevel>, std::vector<PriceLevel>> levels;
-            std::vector<PriceLevel> bids;
-            std::vector<PriceLevel> asks;
+            copy_levels(depth, std::get<0>(levels), std::get<1>(levels));
+            return levels;
+        }
 
+        // overwrites bids and asks in place, recycled vectors with enough capacity do not allocate
+        void copy_levels(const size_t depth, std::vector<PriceLevel> &bids, std::vector<PriceLevel> &asks) const {
+            bids.clear();
+            asks.clear();
             size_t count = 0;
             for (const auto &level: bids_ | std::views::values) {
                 if (count >= depth) break;
@@ -83,12 +88,9 @@ namespace common::models {
                 asks.push_back(level);
                 count++;
             }
-            std::get<0>(levels) = bids;
-            std::get<1>(levels) = asks;
-            return levels;
         }
 
-        void add(const std::int32_t price, const std::int32_t volume, const bool is_bid) {
+        void add(const types::Price price, const types::Quantity volume, const bool is_bid) {
 
             if (!is_valid_price(price) || volume <= 0) {
                 return; // Invalid price or volume
@@ -110,7 +112,7 @@ namespace common::models {
             asks_.emplace(price, PriceLevel{price, volume});
         }
 
-        int remove(const int32_t price, const bool is_bid) {
+        int remove(const types::Price price, const bool is_bid) {
 
             if (!is_valid_price(price)) {
                 return -2; // Invalid price
@@ -129,8 +131,8 @@ namespace common::models {
         }
 
     private:
-        static bool is_valid_price(const uint32_t price) {
-            return price > 0.0;
+        static bool is_valid_price(const types::Price price) {
+            return price > 0;
         }
     };
 }
\ No newline at end of file
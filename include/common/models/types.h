@@ -3,13 +3,16 @@
 //
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 namespace common::models::types {
 
-    using Price = int32_t;
-    using Quantity = int32_t;
-    using Symbol = int8_t;
+    // exact mantissas at the symbol's tick_size / step_size, see common::rounding::FixedPoint
+    using Price = int64_t;
+    using Quantity = int64_t;
+    // dense id handed out by common::reference::ReferenceDataService
+    using Symbol = uint16_t;
     using TickSize = int;
     using StepSize = int;
 
@@ -0,0 +1,141 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace common::parsing {
+
+    constexpr size_t CSV_BLOCK_SIZE = 64;
+
+    // Bitmask of the ',' and '\n' positions in a 64 byte block - bit i set means data[i] is structural.
+    inline uint64_t structural_mask(const char *data) noexcept {
+#if defined(__AVX2__)
+        const __m256i comma = _mm256_set1_epi8(',');
+        const __m256i newline = _mm256_set1_epi8('\n');
+        const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+        const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + 32));
+        const auto lo_mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(lo, comma), _mm256_cmpeq_epi8(lo, newline))));
+        const auto hi_mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(hi, comma), _mm256_cmpeq_epi8(hi, newline))));
+        return static_cast<uint64_t>(hi_mask) << 32 | lo_mask;
+#elif defined(__SSE2__)
+        const __m128i comma = _mm_set1_epi8(',');
+        const __m128i newline = _mm_set1_epi8('\n');
+        uint64_t mask = 0;
+        for (int i = 0; i < 4; ++i) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 16));
+            const auto m = static_cast<uint32_t>(_mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(v, comma), _mm_cmpeq_epi8(v, newline))));
+            mask |= static_cast<uint64_t>(m) << (i * 16);
+        }
+        return mask;
+#else
+        uint64_t mask = 0;
+        for (size_t i = 0; i < CSV_BLOCK_SIZE; ++i) {
+            mask |= static_cast<uint64_t>(data[i] == ',' || data[i] == '\n') << i;
+        }
+        return mask;
+#endif
+    }
+
+    // Splits a buffer of csv rows into fields, 64 bytes at a time, and calls on_row with a span of
+    // string_views into the buffer for every complete row. Returns the number of bytes consumed, i.e.
+    // up to and including the last '\n' - a trailing partial row is left for the caller.
+    // Binance archives never quote fields, so quoting is not handled. Fields past MaxFields are dropped.
+    template<size_t MaxFields, typename RowFn>
+    size_t tokenize_rows(const std::string_view buffer, RowFn &&on_row) {
+        std::array<std::string_view, MaxFields> fields;
+        size_t field_count = 0;
+        size_t field_start = 0;
+        size_t consumed = 0;
+        const char *data = buffer.data();
+        const size_t len = buffer.size();
+
+        auto on_structural = [&](const size_t i) {
+            std::string_view field(data + field_start, i - field_start);
+            if (data[i] == '\n') {
+                if (!field.empty() && field.back() == '\r') {
+                    field.remove_suffix(1);
+                }
+                if (field_count < MaxFields) {
+                    fields[field_count++] = field;
+                }
+                // skip blank lines
+                if (field_count > 1 || !fields[0].empty()) {
+                    on_row(std::span<const std::string_view>(fields.data(), field_count));
+                }
+                field_count = 0;
+                consumed = i + 1;
+            } else if (field_count < MaxFields) {
+                fields[field_count++] = field;
+            }
+            field_start = i + 1;
+        };
+
+        size_t pos = 0;
+        for (; pos + CSV_BLOCK_SIZE <= len; pos += CSV_BLOCK_SIZE) {
+            for (uint64_t mask = structural_mask(data + pos); mask != 0; mask &= mask - 1) {
+                on_structural(pos + static_cast<size_t>(__builtin_ctzll(mask)));
+            }
+        }
+        for (; pos < len; ++pos) {
+            if (data[pos] == ',' || data[pos] == '\n') {
+                on_structural(pos);
+            }
+        }
+        return consumed;
+    }
+
+    // Feeds arbitrarily split chunks (file reads, inflated http bodies) through tokenize_rows.
+    // Complete rows are tokenized in place; only a row straddling two chunks is copied.
+    template<size_t MaxFields, typename RowFn>
+    class CsvRowReader {
+        RowFn on_row_;
+        std::string partial_;
+
+    public:
+        explicit CsvRowReader(RowFn on_row) : on_row_(std::move(on_row)) {}
+
+        void feed(std::string_view chunk) {
+            if (!partial_.empty()) {
+                const auto newline = chunk.find('\n');
+                if (newline == std::string_view::npos) {
+                    partial_.append(chunk);
+                    return;
+                }
+                partial_.append(chunk.substr(0, newline + 1));
+                tokenize_rows<MaxFields>(partial_, on_row_);
+                partial_.clear();
+                chunk.remove_prefix(newline + 1);
+            }
+            const size_t consumed = tokenize_rows<MaxFields>(chunk, on_row_);
+            partial_.append(chunk.substr(consumed));
+        }
+
+        void finish() {
+            if (!partial_.empty()) {
+                partial_.push_back('\n');
+                tokenize_rows<MaxFields>(partial_, on_row_);
+                partial_.clear();
+            }
+        }
+    };
+
+    template<size_t MaxFields, typename RowFn>
+    auto make_csv_row_reader(RowFn &&on_row) {
+        return CsvRowReader<MaxFields, std::decay_t<RowFn>>(std::forward<RowFn>(on_row));
+    }
+}
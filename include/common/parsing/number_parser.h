@@ -0,0 +1,52 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace common::parsing {
+
+    // Locale-free parsers for the numeric fields in the Binance archive csvs.
+    // They never allocate or throw; a false return means the field was malformed.
+
+    [[nodiscard]] inline bool parse_int64(const std::string_view s, int64_t &out) noexcept {
+        const char *p = s.data();
+        const char *end = p + s.size();
+        bool negative = false;
+        if (p != end && *p == '-') {
+            negative = true;
+            ++p;
+        }
+        if (p == end || end - p > 19) {
+            return false;
+        }
+        uint64_t value = 0;
+        for (; p != end; ++p) {
+            const auto digit = static_cast<uint64_t>(*p - '0');
+            if (digit > 9) {
+                return false;
+            }
+            value = value * 10 + digit;
+        }
+        if (value > static_cast<uint64_t>(INT64_MAX) + negative) {
+            return false;
+        }
+        out = negative ? static_cast<int64_t>(0 - value) : static_cast<int64_t>(value);
+        return true;
+    }
+
+    [[nodiscard]] inline bool parse_bool(const std::string_view s, bool &out) noexcept {
+        if (s == "true" || s == "True") {
+            out = true;
+            return true;
+        }
+        if (s == "false" || s == "False") {
+            out = false;
+            return true;
+        }
+        return false;
+    }
+}
@@ -0,0 +1,201 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "common/parsing/csv_tokenizer.h"
+
+namespace common::parsing {
+
+    constexpr size_t DEFAULT_PARSE_SLICE_SIZE = 2 * 1024 * 1024;
+
+    // Parses a csv byte stream on several threads without giving up row order.
+    //
+    // Input is buffered into windows of threads * slice_size bytes. Each window is cut into one
+    // newline aligned slice per thread, every slice is tokenized and parsed into its own Batch,
+    // and the batches are handed to emit in input order - so a sorted file (trade ids, timestamps)
+    // comes out sorted. The feeding thread parses the first slice itself, so threads = 1 runs inline.
+    // The threads - 1 workers are started once and live as long as the parser, a window only wakes them.
+    //
+    // parse(fields, batch) is called concurrently from several threads and must only touch batch.
+    // emit(batch) is always called from the feeding thread and may move the batch away, every slice
+    // starts from a value initialised Batch. An exception thrown by parse is rethrown from feed/finish.
+    template<size_t MaxFields, typename Batch, typename ParseFn, typename EmitFn>
+    class ParallelCsvParser {
+        const size_t threads_;
+        const size_t window_size_;
+        ParseFn parse_;
+        EmitFn emit_;
+        std::string buffer_;
+        std::vector<Batch> outputs_;
+
+        // hand off to the workers: slice i of generation_ belongs to worker i, pending_ counts unfinished ones
+        std::mutex mutex_;
+        std::condition_variable work_ready_;
+        std::condition_variable work_done_;
+        std::vector<std::string_view> slices_;
+        uint64_t generation_ = 0;
+        size_t pending_ = 0;
+        bool stopping_ = false;
+        std::exception_ptr error_;
+        std::vector<std::thread> workers_;
+
+    public:
+        ParallelCsvParser(const size_t threads, const size_t slice_size, ParseFn parse, EmitFn emit) :
+            threads_(std::max<size_t>(threads, 1)),
+            window_size_(threads_ * std::max<size_t>(slice_size, 1)),
+            parse_(std::move(parse)),
+            emit_(std::move(emit)),
+            outputs_(threads_) {
+            buffer_.reserve(window_size_ + window_size_ / 4);
+            slices_.reserve(threads_);
+            workers_.reserve(threads_ - 1);
+            for (size_t i = 1; i < threads_; ++i) {
+                workers_.emplace_back([this, i] { run_worker(i); });
+            }
+        }
+
+        // the workers hold this
+        ParallelCsvParser(const ParallelCsvParser &) = delete;
+        ParallelCsvParser &operator=(const ParallelCsvParser &) = delete;
+
+        ~ParallelCsvParser() {
+            {
+                std::lock_guard lock(mutex_);
+                stopping_ = true;
+            }
+            work_ready_.notify_all();
+            for (auto &worker : workers_) {
+                worker.join();
+            }
+        }
+
+        void feed(const std::string_view bytes) {
+            buffer_.append(bytes);
+            if (buffer_.size() < window_size_) {
+                return;
+            }
+            const auto last_newline = buffer_.rfind('\n');
+            if (last_newline == std::string::npos) {
+                return;
+            }
+            parse_window(std::string_view(buffer_).substr(0, last_newline + 1));
+            // only the partial last line is carried over
+            buffer_.erase(0, last_newline + 1);
+        }
+
+        void finish() {
+            if (!buffer_.empty()) {
+                parse_window(buffer_);
+                buffer_.clear();
+            }
+        }
+
+    private:
+        void parse_window(const std::string_view window) {
+            {
+                std::lock_guard lock(mutex_);
+                slices_.clear();
+                const size_t target = (window.size() + threads_ - 1) / threads_;
+                for (size_t begin = 0; begin < window.size();) {
+                    size_t end = std::min(begin + target, window.size());
+                    if (end < window.size()) {
+                        const auto newline = window.find('\n', end - 1);
+                        end = newline == std::string_view::npos ? window.size() : newline + 1;
+                    }
+                    slices_.push_back(window.substr(begin, end - begin));
+                    begin = end;
+                }
+                pending_ = slices_.empty() ? 0 : slices_.size() - 1;
+                ++generation_;
+            }
+            if (!workers_.empty()) {
+                work_ready_.notify_all();
+            }
+
+            std::exception_ptr error;
+            if (!slices_.empty()) {
+                try {
+                    parse_slice(slices_[0], outputs_[0]);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            {
+                // the workers read the window out of buffer_, so wait for them even when slice 0 threw
+                std::unique_lock lock(mutex_);
+                work_done_.wait(lock, [this] { return pending_ == 0; });
+                if (!error) {
+                    error = std::exchange(error_, nullptr);
+                }
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            for (size_t i = 0; i < slices_.size(); ++i) {
+                emit_(outputs_[i]);
+            }
+        }
+
+        void run_worker(const size_t index) {
+            uint64_t seen = 0;
+            for (;;) {
+                std::string_view slice;
+                {
+                    std::unique_lock lock(mutex_);
+                    work_ready_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                    if (stopping_) {
+                        return;
+                    }
+                    seen = generation_;
+                    if (index >= slices_.size()) {
+                        // a short window has fewer slices than threads
+                        continue;
+                    }
+                    slice = slices_[index];
+                }
+                std::exception_ptr error;
+                try {
+                    parse_slice(slice, outputs_[index]);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                std::lock_guard lock(mutex_);
+                if (error && !error_) {
+                    error_ = error;
+                }
+                if (--pending_ == 0) {
+                    work_done_.notify_one();
+                }
+            }
+        }
+
+        void parse_slice(const std::string_view slice, Batch &out) {
+            out = Batch{};
+            auto rows = make_csv_row_reader<MaxFields>([&](const std::span<const std::string_view> fields) {
+                parse_(fields, out);
+            });
+            rows.feed(slice);
+            rows.finish();
+        }
+    };
+
+    template<size_t MaxFields, typename Batch, typename ParseFn, typename EmitFn>
+    auto make_parallel_csv_parser(const size_t threads, const size_t slice_size, ParseFn &&parse, EmitFn &&emit) {
+        return ParallelCsvParser<MaxFields, Batch, std::decay_t<ParseFn>, std::decay_t<EmitFn>>(
+            threads, slice_size, std::forward<ParseFn>(parse), std::forward<EmitFn>(emit));
+    }
+}
@@ -0,0 +1,97 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "common/models/types.h"
+#include "common/rounding/fixed_point.h"
+
+namespace common::reference {
+
+    using models::types::Symbol;
+    using models::types::TickSize;
+    using models::types::StepSize;
+    using PriceCodec = rounding::DecimalCodec<models::types::Price>;
+
+    // Binance archives carry at most 8 decimals. A symbol's tick and step size change over its life, so rows
+    // from older archives can be finer than today's exchangeInfo - archive values keep at least this many.
+    constexpr int ARCHIVE_PRECISION = 8;
+
+    constexpr auto BINANCE_FUTURES_EXCHANGE_INFO_URL = "https://fapi.binance.com/fapi/v1/exchangeInfo";
+    constexpr auto BINANCE_SPOT_EXCHANGE_INFO_URL = "https://api.binance.com/api/v3/exchangeInfo";
+
+    // Interns symbol names into dense ids 0..size()-1 and keeps the per-symbol scales in flat arrays,
+    // so hot paths carry a Symbol and index instead of hashing strings.
+    // Built once at start up and shared read-only afterwards.
+    class ReferenceDataService {
+        // resolved once in add(), so parsers and the writer never dispatch on a precision per value
+        struct Codecs {
+            const PriceCodec *price;
+            const PriceCodec *quantity;
+            // archive rows (trades, klines): tick_size / step_size digits but never fewer than ARCHIVE_PRECISION
+            const PriceCodec *archive_price;
+            const PriceCodec *archive_quantity;
+            const PriceCodec *notional; // price * quantity, tick_size + step_size digits, at least ARCHIVE_PRECISION
+        };
+
+        std::vector<std::string> names_;
+        std::vector<TickSize> tick_sizes_;
+        std::vector<StepSize> step_sizes_;
+        std::vector<Codecs> codecs_;
+        // keyed by the upper-cased name, lookups are case-insensitive
+        std::unordered_map<std::string, Symbol> ids_;
+
+    public:
+        ReferenceDataService() = default;
+
+        // exchangeInfo response (or a file holding one). Scales come from pricePrecision/quantityPrecision when
+        // present (futures), else from the decimals of the PRICE_FILTER tickSize and LOT_SIZE stepSize (spot).
+        // A non-empty symbols list keeps only those, ids follow its order; a missing symbol throws.
+        static ReferenceDataService from_exchange_info(const nlohmann::json &exchange_info, const std::vector<std::string> &symbols = {});
+        static ReferenceDataService from_file(const std::filesystem::path &path, const std::vector<std::string> &symbols = {});
+        static ReferenceDataService from_url(const std::string &url, const std::vector<std::string> &symbols = {});
+
+        // returns the existing id if the name is already known, throws std::out_of_range
+        // when tick_size + step_size digits do not fit a Price
+        Symbol add(std::string_view name, TickSize tick_size, StepSize step_size);
+
+        [[nodiscard]] std::optional<Symbol> find(std::string_view name) const;
+
+        [[nodiscard]] Symbol id(const std::string_view name) const {
+            const auto symbol = find(name);
+            [[unlikely]] if (!symbol.has_value()) {
+                throw std::out_of_range("Unknown symbol: " + std::string(name));
+            }
+            return *symbol;
+        }
+
+        [[nodiscard]] std::vector<Symbol> ids(const std::vector<std::string> &names) const {
+            std::vector<Symbol> symbols;
+            symbols.reserve(names.size());
+            for (const auto &name : names) {
+                symbols.push_back(id(name));
+            }
+            return symbols;
+        }
+
+        [[nodiscard]] const std::string &name(const Symbol symbol) const noexcept { return names_[symbol]; }
+        [[nodiscard]] TickSize tick_size(const Symbol symbol) const noexcept { return tick_sizes_[symbol]; }
+        [[nodiscard]] StepSize step_size(const Symbol symbol) const noexcept { return step_sizes_[symbol]; }
+        [[nodiscard]] const PriceCodec &price_codec(const Symbol symbol) const noexcept { return *codecs_[symbol].price; }
+        [[nodiscard]] const PriceCodec &quantity_codec(const Symbol symbol) const noexcept { return *codecs_[symbol].quantity; }
+        [[nodiscard]] const PriceCodec &archive_price_codec(const Symbol symbol) const noexcept { return *codecs_[symbol].archive_price; }
+        [[nodiscard]] const PriceCodec &archive_quantity_codec(const Symbol symbol) const noexcept { return *codecs_[symbol].archive_quantity; }
+        [[nodiscard]] const PriceCodec &notional_codec(const Symbol symbol) const noexcept { return *codecs_[symbol].notional; }
+        [[nodiscard]] size_t size() const noexcept { return names_.size(); }
+    };
+}
@@ -4,33 +4,311 @@
 
 #ifndef BINANCEHISTORICDATAFETCHER_FIXED_POINT_H
 #define BINANCEHISTORICDATAFETCHER_FIXED_POINT_H
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace common::rounding {
 
+    // 10^0 .. 10^18 - every power that fits in an int64
+    constexpr size_t MAX_PRECISION = 18;
+
+    constexpr auto POW10 = [] {
+        std::array<std::int64_t, MAX_PRECISION + 1> table{};
+        table[0] = 1;
+        for (size_t i = 1; i < table.size(); ++i) {
+            table[i] = table[i - 1] * 10;
+        }
+        return table;
+    }();
+
+    namespace detail {
+
+        // Parses a plain decimal string ("-123.4500") straight into value * 10^precision.
+        // No allocation, no floating point and no exceptions: returns false for malformed input or a
+        // result that does not fit in Rep. A non-zero digit beyond the requested precision fails too,
+        // unless round is set - then the value is rounded half away from zero.
+        // Inlined with a constant precision the final scaling folds into a multiply by a constant.
+        template<std::signed_integral Rep>
+        [[nodiscard]] constexpr bool parse_decimal(const std::string_view s, const int precision, Rep &out, const bool round = false) noexcept {
+            if (precision < 0 || precision > std::numeric_limits<Rep>::digits10) {
+                return false;
+            }
+            const char *p = s.data();
+            const char *end = p + s.size();
+            bool negative = false;
+            if (p != end && (*p == '-' || *p == '+')) {
+                negative = *p == '-';
+                ++p;
+            }
+            constexpr auto limit = static_cast<std::uint64_t>(std::numeric_limits<Rep>::max());
+            std::uint64_t value = 0;
+            int digits = 0;
+            int fraction_digits = -1;
+            bool round_up = false;
+            for (; p != end; ++p) {
+                if (*p == '.') {
+                    if (fraction_digits >= 0) {
+                        return false;
+                    }
+                    fraction_digits = 0;
+                    continue;
+                }
+                const auto digit = static_cast<std::uint64_t>(*p - '0');
+                if (digit > 9) {
+                    return false;
+                }
+                ++digits;
+                if (fraction_digits >= 0 && fraction_digits++ >= precision) {
+                    // trailing zeros past the precision are harmless padding, anything else would be rounded away
+                    if (digit != 0 && !round) {
+                        return false;
+                    }
+                    if (fraction_digits == precision + 1) {
+                        round_up = digit >= 5;
+                    }
+                    continue;
+                }
+                if (value > (limit - digit) / 10) {
+                    return false;
+                }
+                value = value * 10 + digit;
+            }
+            if (digits == 0) {
+                return false;
+            }
+            const int scale_digits = precision - std::max(fraction_digits, 0);
+            if (scale_digits > 0) {
+                const auto scale = static_cast<std::uint64_t>(POW10[scale_digits]);
+                if (value > limit / scale) {
+                    return false;
+                }
+                value *= scale;
+            }
+            // the magnitude is rounded, so this is away from zero for either sign
+            if (round_up) {
+                if (value == limit) {
+                    return false;
+                }
+                ++value;
+            }
+            out = negative ? static_cast<Rep>(-static_cast<Rep>(value)) : static_cast<Rep>(value);
+            return true;
+        }
+
+        // n / d rounded half away from zero, d != 0
+        template<std::signed_integral Rep>
+        constexpr Rep divide_rounded(const Rep n, const Rep d) noexcept {
+            const Rep quotient = n / d;
+            const Rep remainder = n % d;
+            const Rep abs_remainder = remainder < 0 ? -remainder : remainder;
+            const Rep abs_divisor = d < 0 ? -d : d;
+            if (abs_remainder >= abs_divisor - abs_remainder) {
+                return (n < 0) == (d < 0) ? quotient + 1 : quotient - 1;
+            }
+            return quotient;
+        }
+    }
+
+    // Decimal value with Scale fractional digits fixed at compile time, stored as the exact mantissa
+    // raw() == value * 10^Scale. Conversions are checked: parsing reports failure, everything else that
+    // could overflow Rep or lose digits throws std::overflow_error / std::out_of_range.
+    template<std::signed_integral Rep, int Scale>
     class FixedPoint {
+        static_assert(Scale >= 0 && Scale <= std::numeric_limits<Rep>::digits10, "10^Scale must fit in Rep");
+
+        Rep raw_{0};
+
+        constexpr explicit FixedPoint(const Rep raw) noexcept : raw_(raw) {}
 
     public:
+        using rep = Rep;
+        static constexpr int SCALE = Scale;
+        static constexpr Rep ONE = static_cast<Rep>(POW10[Scale]);
+
+        constexpr FixedPoint() = default;
+
+        [[nodiscard]] static constexpr FixedPoint from_raw(const Rep raw) noexcept {
+            return FixedPoint(raw);
+        }
+
+        [[nodiscard]] static constexpr bool try_parse(const std::string_view s, FixedPoint &out) noexcept {
+            return detail::parse_decimal(s, Scale, out.raw_);
+        }
+
+        // digits beyond Scale are rounded half away from zero instead of failing the parse
+        [[nodiscard]] static constexpr bool try_parse_rounded(const std::string_view s, FixedPoint &out) noexcept {
+            return detail::parse_decimal(s, Scale, out.raw_, true);
+        }
+
+        // throwing convenience wrapper for cold paths (config, REST snapshots)
+        [[nodiscard]] static FixedPoint from_string(const std::string_view s) {
+            FixedPoint value;
+            if (!try_parse(s, value)) {
+                throw std::invalid_argument("Invalid fixed point value: " + std::string(s));
+            }
+            return value;
+        }
+
+        // rounds to the nearest mantissa, half away from zero
+        [[nodiscard]] static FixedPoint from_double(const double value) {
+            const double scaled = std::round(value * static_cast<double>(ONE));
+            // 2^63 is exact as a double while INT64_MAX is not, so compare against the exclusive bound
+            constexpr double bound = -static_cast<double>(std::numeric_limits<Rep>::min());
+            if (!std::isfinite(scaled) || scaled >= bound || scaled < -bound) {
+                throw std::out_of_range("Value does not fit the fixed point range: " + std::to_string(value));
+            }
+            return FixedPoint(static_cast<Rep>(scaled));
+        }
+
+        [[nodiscard]] constexpr Rep raw() const noexcept { return raw_; }
+
+        [[nodiscard]] constexpr double to_double() const noexcept {
+            return static_cast<double>(raw_) / static_cast<double>(ONE);
+        }
+
+        // widening is exact, narrowing rounds half away from zero
+        template<int To>
+        [[nodiscard]] constexpr FixedPoint<Rep, To> rescale() const {
+            if constexpr (To >= Scale) {
+                Rep raw;
+                if (__builtin_mul_overflow(raw_, static_cast<Rep>(POW10[To - Scale]), &raw)) {
+                    throw std::overflow_error("Fixed point rescale overflow");
+                }
+                return FixedPoint<Rep, To>::from_raw(raw);
+            } else {
+                return FixedPoint<Rep, To>::from_raw(detail::divide_rounded(raw_, static_cast<Rep>(POW10[Scale - To])));
+            }
+        }
+
+        constexpr FixedPoint operator+(const FixedPoint other) const {
+            Rep raw;
+            if (__builtin_add_overflow(raw_, other.raw_, &raw)) {
+                throw std::overflow_error("Fixed point addition overflow");
+            }
+            return FixedPoint(raw);
+        }
 
-        FixedPoint() = default;
+        constexpr FixedPoint operator-(const FixedPoint other) const {
+            Rep raw;
+            if (__builtin_sub_overflow(raw_, other.raw_, &raw)) {
+                throw std::overflow_error("Fixed point subtraction overflow");
+            }
+            return FixedPoint(raw);
+        }
 
-       ~FixedPoint() = default;
+        constexpr FixedPoint &operator+=(const FixedPoint other) { return *this = *this + other; }
+        constexpr FixedPoint &operator-=(const FixedPoint other) { return *this = *this - other; }
 
-        [[nodiscard]] static std::int32_t from_string(const std::string &s, const int &precision) {
-            const double value = std::stod(s);
-            const double scaled_value = value * calc_scale_factor(precision);
-            return static_cast<std::int32_t>(std::round(scaled_value));
+        // exact product, the scales add up: price * quantity is the notional
+        template<int OtherScale>
+        constexpr FixedPoint<Rep, Scale + OtherScale> operator*(const FixedPoint<Rep, OtherScale> other) const {
+            Rep raw;
+            if (__builtin_mul_overflow(raw_, other.raw(), &raw)) {
+                throw std::overflow_error("Fixed point multiplication overflow");
+            }
+            return FixedPoint<Rep, Scale + OtherScale>::from_raw(raw);
         }
 
-        [[nodiscard]] static double to_double(const std::int32_t &fp, const int &precision) {
-            return static_cast<double>(fp) / calc_scale_factor(precision);
+        // the scales subtract, rounded half away from zero: notional / quantity is the average price
+        template<int OtherScale>
+        constexpr FixedPoint<Rep, Scale - OtherScale> operator/(const FixedPoint<Rep, OtherScale> other) const {
+            if (other.raw() == 0) {
+                throw std::domain_error("Fixed point division by zero");
+            }
+            return FixedPoint<Rep, Scale - OtherScale>::from_raw(detail::divide_rounded(raw_, other.raw()));
         }
 
-    private:
-        static double calc_scale_factor(const int &precision) {
-            return std::pow(10.0, static_cast<double>(precision));
+        constexpr auto operator<=>(const FixedPoint &) const = default;
+    };
+
+    // Volume weighted average price over (price, quantity) pairs. The notional is accumulated exactly
+    // at PriceScale + QuantityScale digits, only value() rounds.
+    template<std::signed_integral Rep, int PriceScale, int QuantityScale>
+    class Vwap {
+        FixedPoint<Rep, PriceScale + QuantityScale> notional_{};
+        FixedPoint<Rep, QuantityScale> quantity_{};
+
+    public:
+        constexpr void add(const FixedPoint<Rep, PriceScale> price, const FixedPoint<Rep, QuantityScale> quantity) {
+            notional_ += price * quantity;
+            quantity_ += quantity;
+        }
+
+        [[nodiscard]] constexpr FixedPoint<Rep, PriceScale> value() const {
+            return notional_ / quantity_;
         }
+
+        [[nodiscard]] constexpr FixedPoint<Rep, PriceScale + QuantityScale> notional() const noexcept { return notional_; }
+        [[nodiscard]] constexpr FixedPoint<Rep, QuantityScale> quantity() const noexcept { return quantity_; }
     };
+
+    // Per-symbol precisions are only known at run time. A codec is resolved once per symbol, parse runs
+    // FixedPoint<Rep, precision>::try_parse and column conversions divide by its ONE, hoisted into divisor,
+    // so no call looks up a power of ten.
+    template<std::signed_integral Rep>
+    struct DecimalCodec {
+        int precision;
+        double divisor; // 10^precision
+        // exact: digits beyond precision fail the parse
+        bool (*parse)(std::string_view, Rep &) noexcept;
+        // digits beyond precision are rounded half away from zero
+        bool (*parse_rounded)(std::string_view, Rep &) noexcept;
+
+        [[nodiscard]] double to_double(const Rep raw) const noexcept {
+            return static_cast<double>(raw) / divisor;
+        }
+    };
+
+    namespace detail {
+
+        template<std::signed_integral Rep, int Precision>
+        bool parse_at(const std::string_view s, Rep &out) noexcept {
+            FixedPoint<Rep, Precision> value;
+            if (!FixedPoint<Rep, Precision>::try_parse(s, value)) {
+                return false;
+            }
+            out = value.raw();
+            return true;
+        }
+
+        template<std::signed_integral Rep, int Precision>
+        bool parse_rounded_at(const std::string_view s, Rep &out) noexcept {
+            FixedPoint<Rep, Precision> value;
+            if (!FixedPoint<Rep, Precision>::try_parse_rounded(s, value)) {
+                return false;
+            }
+            out = value.raw();
+            return true;
+        }
+
+        template<std::signed_integral Rep, int... Precision>
+        constexpr auto make_codecs(std::integer_sequence<int, Precision...>) {
+            return std::array<DecimalCodec<Rep>, sizeof...(Precision)>{
+                DecimalCodec<Rep>{Precision, static_cast<double>(FixedPoint<Rep, Precision>::ONE),
+                                  &parse_at<Rep, Precision>, &parse_rounded_at<Rep, Precision>}...
+            };
+        }
+    }
+
+    // one codec for every precision Rep can hold
+    template<std::signed_integral Rep>
+    constexpr auto DECIMAL_CODECS = detail::make_codecs<Rep>(std::make_integer_sequence<int, std::numeric_limits<Rep>::digits10 + 1>{});
+
+    template<std::signed_integral Rep>
+    const DecimalCodec<Rep> &decimal_codec(const int precision) {
+        if (precision < 0 || static_cast<size_t>(precision) >= DECIMAL_CODECS<Rep>.size()) {
+            throw std::out_of_range("Unsupported fixed point precision: " + std::to_string(precision));
+        }
+        return DECIMAL_CODECS<Rep>[precision];
+    }
 }
-#endif //BINANCEHISTORICDATAFETCHER_FIXED_POINT_H
\ No newline at end of file
+#endif //BINANCEHISTORICDATAFETCHER_FIXED_POINT_H
@@ -0,0 +1,91 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace common::sync {
+
+    // Bounded multi producer / multi consumer queue between pipeline stages.
+    //
+    // push blocks while the queue is full, which is what throttles an upstream stage to the pace of
+    // the downstream one. close() wakes everybody: pushes fail from then on, pops drain what is left
+    // and then return nullopt. Items here are whole archives, so a mutex is plenty.
+    template<typename T>
+    class BlockingQueue {
+        const size_t capacity_;
+        std::deque<T> items_;
+        bool closed_{false};
+        mutable std::mutex mutex_;
+        std::condition_variable not_empty_;
+        std::condition_variable not_full_;
+
+    public:
+        explicit BlockingQueue(const size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+        bool push(T item) {
+            std::unique_lock lock(mutex_);
+            not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+            if (closed_) {
+                return false;
+            }
+            items_.push_back(std::move(item));
+            lock.unlock();
+            not_empty_.notify_one();
+            return true;
+        }
+
+        std::optional<T> pop() {
+            std::unique_lock lock(mutex_);
+            not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+            if (items_.empty()) {
+                return std::nullopt;
+            }
+            T item = std::move(items_.front());
+            items_.pop_front();
+            lock.unlock();
+            not_full_.notify_one();
+            return item;
+        }
+
+        // like pop, but gives up after timeout - nullopt then means timed out or closed and drained
+        template<typename Rep, typename Period>
+        std::optional<T> pop_for(const std::chrono::duration<Rep, Period> timeout) {
+            std::unique_lock lock(mutex_);
+            not_empty_.wait_for(lock, timeout, [this] { return closed_ || !items_.empty(); });
+            if (items_.empty()) {
+                return std::nullopt;
+            }
+            T item = std::move(items_.front());
+            items_.pop_front();
+            lock.unlock();
+            not_full_.notify_one();
+            return item;
+        }
+
+        void close() {
+            {
+                std::lock_guard lock(mutex_);
+                closed_ = true;
+            }
+            not_empty_.notify_all();
+            not_full_.notify_all();
+        }
+
+        [[nodiscard]] bool closed() const {
+            std::lock_guard lock(mutex_);
+            return closed_;
+        }
+
+        [[nodiscard]] size_t size() const {
+            std::lock_guard lock(mutex_);
+            return items_.size();
+        }
+    };
+}
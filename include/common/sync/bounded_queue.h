@@ -0,0 +1,243 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <concurrentqueue/concurrentqueue.h>
+
+#include "common/sync/wait_strategy.h"
+
+namespace common::sync {
+
+    enum class OverflowPolicy {
+        BLOCK,        // producers wait for room - nothing is lost, a slow sink slows the source
+        DROP_OLDEST,  // the oldest queued events make room - the freshest data wins
+        DROP_NEWEST,  // events that do not fit are discarded
+    };
+
+    inline OverflowPolicy getOverflowPolicy(const std::string_view name) {
+        if (name == "block") return OverflowPolicy::BLOCK;
+        if (name == "drop_oldest") return OverflowPolicy::DROP_OLDEST;
+        if (name == "drop_newest") return OverflowPolicy::DROP_NEWEST;
+        throw std::invalid_argument("Unknown overflow policy: " + std::string(name));
+    }
+
+    inline std::string getOverflowPolicyName(const OverflowPolicy policy) {
+        switch (policy) {
+            case OverflowPolicy::BLOCK: return "block";
+            case OverflowPolicy::DROP_OLDEST: return "drop_oldest";
+            case OverflowPolicy::DROP_NEWEST: return "drop_newest";
+        }
+        return "unknown";
+    }
+
+    struct QueueCounters {
+        size_t depth;
+        size_t high_water;
+        uint64_t enqueued;
+        uint64_t dequeued;
+        uint64_t dropped;
+    };
+
+    // A moodycamel queue with a hard capacity. moodycamel only takes an initial size and grows without
+    // limit, so a stalled consumer would otherwise grow it until the process is killed.
+    //
+    // The depth counter is raised before an enqueue and lowered after a dequeue, so it never under
+    // reports. Under DROP_OLDEST the producer evicts from the head itself; with several producers the
+    // evicted events are the oldest per moodycamel's sub-queue order, not strictly globally.
+    // close() releases blocked producers, their events are counted as dropped.
+    template<typename T>
+    class BoundedQueue {
+        moodycamel::ConcurrentQueue<T> queue_;
+        const size_t capacity_;
+        const OverflowPolicy policy_;
+        std::atomic<size_t> depth_{0};
+        std::atomic<size_t> high_water_{0};
+        std::atomic<uint64_t> enqueued_{0};
+        std::atomic<uint64_t> dequeued_{0};
+        std::atomic<uint64_t> dropped_{0};
+        std::atomic<bool> closed_{false};
+        // rung by consumers once room was made, only producers blocked on a full queue park on it
+        WaitSignal not_full_;
+
+        // claims room for up to count events and returns how many may be enqueued
+        size_t reserve(const size_t count) {
+            if (policy_ == OverflowPolicy::DROP_OLDEST) {
+                const size_t depth = depth_.fetch_add(count, std::memory_order_acq_rel) + count;
+                for (size_t excess = depth > capacity_ ? depth - capacity_ : 0; excess > 0; --excess) {
+                    if (T victim; !queue_.try_dequeue(victim)) {
+                        break;
+                    }
+                    depth_.fetch_sub(1, std::memory_order_acq_rel);
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+                return count;
+            }
+            WaitStrategy wait(WaitOptions{.policy = WaitPolicy::SPIN_PARK}, &not_full_);
+            size_t depth = depth_.load(std::memory_order_acquire);
+            while (true) {
+                const size_t room = depth >= capacity_ ? 0 : capacity_ - depth;
+                // a blocking bulk larger than the whole queue goes into an empty one rather than never
+                const size_t granted = depth == 0 && policy_ == OverflowPolicy::BLOCK ? count : std::min(count, room);
+                if (granted == count || (granted > 0 && policy_ == OverflowPolicy::DROP_NEWEST)) {
+                    if (depth_.compare_exchange_weak(depth, depth + granted, std::memory_order_acq_rel)) {
+                        return granted;
+                    }
+                    continue;
+                }
+                if (policy_ == OverflowPolicy::DROP_NEWEST || closed_.load(std::memory_order_acquire)) {
+                    return 0;
+                }
+                wait.idle();
+                depth = depth_.load(std::memory_order_acquire);
+            }
+        }
+
+        void record_enqueued(const size_t accepted, const size_t offered) {
+            enqueued_.fetch_add(accepted, std::memory_order_relaxed);
+            if (accepted < offered) {
+                dropped_.fetch_add(offered - accepted, std::memory_order_relaxed);
+            }
+            const size_t depth = depth_.load(std::memory_order_relaxed);
+            size_t high_water = high_water_.load(std::memory_order_relaxed);
+            while (depth > high_water && !high_water_.compare_exchange_weak(high_water, depth, std::memory_order_relaxed)) {}
+        }
+
+        void record_dequeued(const size_t count) {
+            if (count == 0) {
+                return;
+            }
+            depth_.fetch_sub(count, std::memory_order_acq_rel);
+            dequeued_.fetch_add(count, std::memory_order_relaxed);
+            if (policy_ == OverflowPolicy::BLOCK) {
+                not_full_.notify();
+            }
+        }
+
+    public:
+        BoundedQueue(const size_t capacity, const OverflowPolicy policy) :
+            queue_(std::max<size_t>(capacity, 1)),
+            capacity_(std::max<size_t>(capacity, 1)),
+            policy_(policy) {}
+
+        BoundedQueue(const BoundedQueue &) = delete;
+        BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+        [[nodiscard]] moodycamel::ProducerToken producer_token() { return moodycamel::ProducerToken(queue_); }
+        [[nodiscard]] moodycamel::ConsumerToken consumer_token() { return moodycamel::ConsumerToken(queue_); }
+
+        // false if the event was dropped (DROP_NEWEST on a full queue, or closed)
+        bool enqueue(T &&item) {
+            const size_t accepted = reserve(1);
+            if (accepted == 1) {
+                queue_.enqueue(std::move(item));
+            }
+            record_enqueued(accepted, 1);
+            return accepted == 1;
+        }
+
+        // moves the first count events out of first, returns how many were taken; the rest stay with
+        // the caller and are counted as dropped
+        template<typename It>
+        size_t enqueue_bulk(moodycamel::ProducerToken &token, It first, const size_t count) {
+            const size_t accepted = count == 0 ? 0 : reserve(count);
+            if (accepted > 0) {
+                queue_.enqueue_bulk(token, std::make_move_iterator(first), accepted);
+            }
+            record_enqueued(accepted, count);
+            return accepted;
+        }
+
+        // for producers without a long lived thread of their own, e.g. pooled parse workers
+        template<typename It>
+        size_t enqueue_bulk(It first, const size_t count) {
+            const size_t accepted = count == 0 ? 0 : reserve(count);
+            if (accepted > 0) {
+                queue_.enqueue_bulk(std::make_move_iterator(first), accepted);
+            }
+            record_enqueued(accepted, count);
+            return accepted;
+        }
+
+        bool try_dequeue(T &item) {
+            if (!queue_.try_dequeue(item)) {
+                return false;
+            }
+            record_dequeued(1);
+            return true;
+        }
+
+        template<typename It>
+        size_t try_dequeue_bulk(moodycamel::ConsumerToken &token, It first, const size_t max) {
+            const size_t count = queue_.try_dequeue_bulk(token, first, max);
+            record_dequeued(count);
+            return count;
+        }
+
+        void close() {
+            closed_.store(true, std::memory_order_release);
+            not_full_.notify();
+        }
+
+        [[nodiscard]] size_t size_approx() const noexcept { return depth_.load(std::memory_order_acquire); }
+        [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+        [[nodiscard]] OverflowPolicy policy() const noexcept { return policy_; }
+
+        [[nodiscard]] QueueCounters counters() const noexcept {
+            return {
+                depth_.load(std::memory_order_relaxed),
+                high_water_.load(std::memory_order_relaxed),
+                enqueued_.load(std::memory_order_relaxed),
+                dequeued_.load(std::memory_order_relaxed),
+                dropped_.load(std::memory_order_relaxed),
+            };
+        }
+    };
+
+    struct QueueSample {
+        QueueCounters counters;
+        double enqueue_rate; // events per second since the previous sample
+        double dequeue_rate;
+    };
+
+    inline std::ostream &operator<<(std::ostream &os, const QueueSample &sample) {
+        const auto &[depth, high_water, enqueued, dequeued, dropped] = sample.counters;
+        return os << "depth=" << depth << " high_water=" << high_water
+                  << " in=" << static_cast<uint64_t>(sample.enqueue_rate) << "/s"
+                  << " out=" << static_cast<uint64_t>(sample.dequeue_rate) << "/s"
+                  << " dropped=" << dropped;
+    }
+
+    // Turns the running counters into rates, sampled by whichever thread reports. Not thread safe.
+    class QueueMeter {
+        using clock = std::chrono::steady_clock;
+
+        QueueCounters last_{};
+        clock::time_point last_at_{clock::now()};
+
+    public:
+        template<typename T>
+        QueueSample sample(const BoundedQueue<T> &queue) {
+            const auto counters = queue.counters();
+            const auto now = clock::now();
+            const double seconds = std::chrono::duration<double>(now - last_at_).count();
+            QueueSample sample{counters, 0.0, 0.0};
+            if (seconds > 0.0) {
+                sample.enqueue_rate = static_cast<double>(counters.enqueued - last_.enqueued) / seconds;
+                sample.dequeue_rate = static_cast<double>(counters.dequeued - last_.dequeued) / seconds;
+            }
+            last_ = counters;
+            last_at_ = now;
+            return sample;
+        }
+    };
+}
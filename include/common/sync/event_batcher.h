@@ -0,0 +1,79 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <concurrentqueue/concurrentqueue.h>
+
+#include "common/sync/bounded_queue.h"
+#include "common/sync/wait_strategy.h"
+
+namespace common::sync {
+
+    // Producer side batching for a bounded queue: events are collected and enqueued in one bulk
+    // once capacity is reached, or once the oldest pending event has waited for timeout, so a slow
+    // stream is never held back for long. Each bulk rings signal, if given, for a parked consumer.
+    // Owned by a single producer thread, not thread safe.
+    template<typename T>
+    class EventBatcher {
+        BoundedQueue<T> &queue_;
+        moodycamel::ProducerToken token_;
+        std::vector<T> pending_;
+        const size_t capacity_;
+        const std::chrono::steady_clock::duration timeout_;
+        std::chrono::steady_clock::time_point oldest_{};
+        WaitSignal *signal_;
+
+    public:
+        EventBatcher(BoundedQueue<T> &queue, const size_t capacity, const std::chrono::steady_clock::duration timeout,
+            WaitSignal *signal = nullptr) :
+            queue_(queue),
+            token_(queue.producer_token()),
+            capacity_(std::max<size_t>(capacity, 1)),
+            timeout_(timeout),
+            signal_(signal) {
+            pending_.reserve(capacity_);
+        }
+
+        ~EventBatcher() {
+            flush();
+        }
+
+        EventBatcher(const EventBatcher &) = delete;
+        EventBatcher &operator=(const EventBatcher &) = delete;
+
+        void push(T &&event) {
+            if (pending_.empty()) {
+                oldest_ = std::chrono::steady_clock::now();
+            }
+            pending_.push_back(std::move(event));
+            if (pending_.size() >= capacity_) {
+                flush();
+                return;
+            }
+            poll();
+        }
+
+        // flushes if the oldest pending event is due, call it when the producer has nothing to push
+        void poll() {
+            if (!pending_.empty() && std::chrono::steady_clock::now() - oldest_ >= timeout_) {
+                flush();
+            }
+        }
+
+        void flush() {
+            if (pending_.empty()) {
+                return;
+            }
+            queue_.enqueue_bulk(token_, pending_.begin(), pending_.size());
+            pending_.clear();
+            if (signal_ != nullptr) {
+                signal_->notify();
+            }
+        }
+    };
+}
@@ -6,10 +6,14 @@
 
 #include <atomic>
 
+#include "common/sync/wait_strategy.h"
+
 namespace common::sync::producer_consumer {
     struct Context {
         std::atomic<bool> producerDone{false};
         std::atomic<bool> consumerDone{false};
         std::atomic<bool> running{true};
+        // rung by producers after enqueueing, wakes a parked consumer
+        WaitSignal dataReady;
     };
 }
\ No newline at end of file
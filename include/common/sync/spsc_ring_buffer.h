@@ -0,0 +1,105 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace common::sync {
+
+    constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // Bounded single producer / single consumer ring. Exactly one thread may call try_emplace/try_push
+    // and exactly one other thread consume/size_approx at a time.
+    //
+    // The two indices live on separate cache lines, each side keeps a private copy of the other side's
+    // index and only re-reads the shared one when its copy says full / empty, so in steady state a push
+    // or a consumed batch touches one shared line. Elements are constructed in place in the slots.
+    template<typename T>
+    class SpscRingBuffer {
+        struct alignas(alignof(T)) Slot {
+            std::byte storage[sizeof(T)];
+        };
+
+        // consumer side
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+        size_t cached_tail_{0};
+        // producer side
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+        size_t cached_head_{0};
+        // read only after construction
+        alignas(CACHE_LINE_SIZE) const size_t mask_;
+        const std::unique_ptr<Slot[]> slots_;
+
+        T *slot(const size_t index) noexcept {
+            return std::launder(reinterpret_cast<T *>(slots_[index & mask_].storage));
+        }
+
+    public:
+        // capacity is rounded up to a power of two
+        explicit SpscRingBuffer(const size_t capacity) :
+            mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+            slots_(std::make_unique<Slot[]>(mask_ + 1)) {}
+
+        ~SpscRingBuffer() {
+            consume([](T &) {});
+        }
+
+        SpscRingBuffer(const SpscRingBuffer &) = delete;
+        SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+        // producer: false if the ring is full, nothing is constructed then
+        template<typename... Args>
+        bool try_emplace(Args &&... args) {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - cached_head_ > mask_) {
+                cached_head_ = head_.load(std::memory_order_acquire);
+                if (tail - cached_head_ > mask_) {
+                    return false;
+                }
+            }
+            ::new (slots_[tail & mask_].storage) T(std::forward<Args>(args)...);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool try_push(T &&value) {
+            return try_emplace(std::move(value));
+        }
+
+        // consumer: calls fn(T &) on up to max elements in order, they are destroyed afterwards and
+        // their slots released in one store. fn must not throw. Returns the number consumed.
+        template<typename Fn>
+        size_t consume(Fn &&fn, const size_t max = std::numeric_limits<size_t>::max()) {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (cached_tail_ == head) {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (cached_tail_ == head) {
+                    return 0;
+                }
+            }
+            const size_t count = std::min(cached_tail_ - head, max);
+            for (size_t i = 0; i < count; ++i) {
+                T *element = slot(head + i);
+                fn(*element);
+                element->~T();
+            }
+            head_.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+        [[nodiscard]] size_t size_approx() const noexcept {
+            return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] size_t capacity() const noexcept { return mask_ + 1; }
+    };
+}
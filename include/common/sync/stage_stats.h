@@ -0,0 +1,53 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace common::sync {
+
+    // Busy/idle accounting for one pipeline stage, shared by all of its threads.
+    //
+    // busy is time spent doing the stage's work, idle is time blocked waiting for input or for room
+    // downstream. The stage with the highest busy share is the bottleneck on the box.
+    class StageStats {
+        const std::string name_;
+        std::atomic<uint64_t> busy_ns_{0};
+        std::atomic<uint64_t> idle_ns_{0};
+        std::atomic<uint64_t> items_{0};
+
+    public:
+        using clock = std::chrono::steady_clock;
+
+        explicit StageStats(std::string name) : name_(std::move(name)) {}
+
+        void add_busy(const clock::duration elapsed) {
+            busy_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+        }
+
+        void add_idle(const clock::duration elapsed) {
+            idle_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+        }
+
+        void add_items(const uint64_t count) {
+            items_.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] const std::string &name() const { return name_; }
+        [[nodiscard]] uint64_t items() const { return items_.load(std::memory_order_relaxed); }
+        [[nodiscard]] double busy_seconds() const { return static_cast<double>(busy_ns_.load(std::memory_order_relaxed)) / 1e9; }
+        [[nodiscard]] double idle_seconds() const { return static_cast<double>(idle_ns_.load(std::memory_order_relaxed)) / 1e9; }
+
+        // share of thread time spent working, 0..1
+        [[nodiscard]] double utilisation() const {
+            const double busy = busy_seconds();
+            const double total = busy + idle_seconds();
+            return total > 0.0 ? busy / total : 0.0;
+        }
+    };
+}
@@ -0,0 +1,115 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace common::sync {
+
+    enum class WaitPolicy {
+        BUSY_SPIN,   // never gives up the core, lowest latency - pin the thread
+        SPIN_YIELD,  // spins briefly, then yields the time slice on every empty poll
+        SPIN_PARK,   // spins, yields, then sleeps on a futex until notified or park_timeout passes
+    };
+
+    inline WaitPolicy getWaitPolicy(const std::string_view name) {
+        if (name == "spin") return WaitPolicy::BUSY_SPIN;
+        if (name == "yield") return WaitPolicy::SPIN_YIELD;
+        if (name == "park") return WaitPolicy::SPIN_PARK;
+        throw std::invalid_argument("Unknown wait strategy: " + std::string(name));
+    }
+
+    struct WaitOptions {
+        WaitPolicy policy{WaitPolicy::SPIN_YIELD};
+        uint32_t spins{128};   // empty polls answered with a cpu pause before yielding
+        uint32_t yields{64};   // further empty polls answered with a yield before parking
+        std::chrono::microseconds park_timeout{1000};
+    };
+
+    // Futex backed doorbell a producer rings after publishing work, so parked consumers wake straight
+    // away instead of at the end of their park timeout. Ringing costs one atomic add while nobody is parked.
+    class WaitSignal {
+        std::atomic<uint32_t> epoch_{0};
+        std::atomic<uint32_t> waiters_{0};
+
+    public:
+        void notify() noexcept {
+            epoch_.fetch_add(1);
+            if (waiters_.load() > 0) {
+                syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch_), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+            }
+        }
+
+        [[nodiscard]] uint32_t epoch() const noexcept { return epoch_.load(); }
+
+        // returns at once if notify was called since epoch() returned seen
+        void wait(const uint32_t seen, const std::chrono::microseconds timeout) noexcept {
+            const auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+            const timespec ts{
+                static_cast<time_t>(secs.count()),
+                static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - secs).count())
+            };
+            waiters_.fetch_add(1);
+            syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch_), FUTEX_WAIT_PRIVATE, seen, &ts, nullptr, 0);
+            waiters_.fetch_sub(1);
+        }
+    };
+
+    inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    // Per consumer thread back off for polling loops: call idle() after every empty poll and reset()
+    // once work was found. Without a signal a parked consumer simply sleeps for park_timeout.
+    class WaitStrategy {
+        const WaitOptions options_;
+        WaitSignal *signal_;
+        uint32_t empty_polls_{0};
+        uint32_t seen_{0};
+
+    public:
+        explicit WaitStrategy(const WaitOptions &options = {}, WaitSignal *signal = nullptr) :
+            options_(options), signal_(signal) {}
+
+        void reset() noexcept {
+            empty_polls_ = 0;
+        }
+
+        void idle() noexcept {
+            const auto polls = empty_polls_;
+            if (polls != UINT32_MAX) {
+                ++empty_polls_;
+            }
+            if (options_.policy == WaitPolicy::BUSY_SPIN || polls < options_.spins) {
+                cpu_relax();
+            } else if (options_.policy == WaitPolicy::SPIN_YIELD || polls < options_.spins + options_.yields) {
+                std::this_thread::yield();
+            } else if (signal_ != nullptr) {
+                // seen_ was read before the poll that just came back empty, so a notify
+                // for anything published since then cannot be missed
+                signal_->wait(seen_, options_.park_timeout);
+            } else {
+                std::this_thread::sleep_for(options_.park_timeout);
+            }
+            if (signal_ != nullptr) {
+                seen_ = signal_->epoch();
+            }
+        }
+    };
+}
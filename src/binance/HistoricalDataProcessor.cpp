@@ -2,16 +2,28 @@
 // Created by jtwears on 9/15/25.
 //
 
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <iomanip>
+#include <iostream>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "binancehistoricaldatafetcher/HistoricalDataProcessor.h"
 #include "binancehistoricaldatafetcher/file_downloader.h"
 #include "common/io/questdb_writer.h"
+#include "common/sync/blocking_queue.h"
+#include "common/sync/bounded_queue.h"
 #include "common/sync/producer_consumer.h"
+#include "common/sync/stage_stats.h"
 
 namespace binance::processor {
 
+    using common::sync::StageStats;
+
     HistoricalDataProcessor::HistoricalDataProcessor(
             const std::shared_ptr<Context> &context,
             std::unique_ptr<writer::QuestDBWriter> writer,
@@ -23,15 +35,190 @@ namespace binance::processor {
     settings_(std::move(app_settings)) {}
 
     void HistoricalDataProcessor::process() {
-        std::thread producer([this]() {
-            downloader_->download(settings_->symbols, settings_->startDate, settings_->endDate);
+        const bool streaming = downloader_->streaming();
+        StageStats fetch_stats(streaming ? "fetch+parse" : "fetch");
+        StageStats parse_stats("parse");
+        const auto start = std::chrono::steady_clock::now();
+
+        std::thread producer([&]() {
+            runProducerStages(fetch_stats, parse_stats);
+        });
+
+        // an exception escaping the consumer thread would terminate the process. It is kept for after the
+        // joins instead, and the writer is closed: that releases producers blocked on its full queue and
+        // clears context_->running, so the fetch stage stops taking new units.
+        std::exception_ptr writer_error;
+        std::thread consumer([this, &writer_error]() {
+            try {
+                writer_->write();
+            } catch (...) {
+                writer_error = std::current_exception();
+                try {
+                    writer_->close();
+                } catch (const std::exception &e) {
+                    std::cerr << "ERROR::HistoricalDataProcessor::process closing the writer failed: " << e.what() << std::endl;
+                } catch (...) {
+                    std::cerr << "ERROR::HistoricalDataProcessor::process closing the writer failed" << std::endl;
+                }
+            }
         });
 
-        std::thread consumer([this]() {
-           writer_->write();
+        // periodic stage report until the writer drained everything
+        std::mutex report_mutex;
+        std::condition_variable report_cv;
+        bool finished = false;
+        std::thread reporter([&]() {
+            common::sync::QueueMeter queue_meter;
+            auto connections = writer_->connectionStats();
+            auto connections_at = std::chrono::steady_clock::now();
+            std::unique_lock lock(report_mutex);
+            while (!report_cv.wait_for(lock, STAGE_REPORT_INTERVAL, [&] { return finished; })) {
+                reportStage(fetch_stats, settings_->parallelism);
+                if (!streaming) {
+                    reportStage(parse_stats, settings_->parseWorkers);
+                }
+                reportStage(writer_->stats(), 1);
+                std::cout << "INFO::HistoricalDataProcessor queue " << queue_meter.sample(writer_->queue()) << std::endl;
+                const auto now = std::chrono::steady_clock::now();
+                const auto latest = writer_->connectionStats();
+                reportConnections(connections, latest, std::chrono::duration<double>(now - connections_at).count());
+                connections = latest;
+                connections_at = now;
+            }
         });
 
         producer.join();
         consumer.join();
+        {
+            std::lock_guard lock(report_mutex);
+            finished = true;
+        }
+        report_cv.notify_one();
+        reporter.join();
+        if (writer_error) {
+            std::rethrow_exception(writer_error);
+        }
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        const double mb = static_cast<double>(downloader_->bytesDownloaded()) / (1024.0 * 1024.0);
+        const double seconds = elapsed.count();
+        std::cout << "INFO::HistoricalDataProcessor::process downloaded " << fetch_stats.items() << " files, "
+                  << std::fixed << std::setprecision(2) << mb << " MB in " << seconds << " s ("
+                  << (seconds > 0.0 ? mb / seconds : 0.0) << " MB/s)" << std::endl;
+        reportStage(fetch_stats, settings_->parallelism);
+        if (!streaming) {
+            reportStage(parse_stats, settings_->parseWorkers);
+        }
+        reportStage(writer_->stats(), 1);
+        const auto queue = writer_->queue().counters();
+        reportConnections({}, writer_->connectionStats(), seconds);
+        std::cout << "INFO::HistoricalDataProcessor queue capacity=" << writer_->queue().capacity()
+                  << " high_water=" << queue.high_water << " blocks=" << queue.dequeued << std::endl;
+    }
+
+    void HistoricalDataProcessor::runProducerStages(StageStats &fetch_stats, StageStats &parse_stats) const {
+        using clock = StageStats::clock;
+        // every (symbol, archive) pair goes into one shared work list so fetch threads pull units independently
+        const auto units = downloader_->pendingUnits(settings_->symbols, settings_->startDate, settings_->endDate);
+        std::atomic<size_t> next_unit{0};
+        common::sync::BlockingQueue<downloader::FetchedArchive> fetched(settings_->prefetch);
+        const bool streaming = downloader_->streaming();
+
+        auto fetch_worker = [&]() {
+            for (size_t i = next_unit.fetch_add(1); i < units.size(); i = next_unit.fetch_add(1)) {
+                if (!context_->running.load()) {
+                    return;
+                }
+                try {
+                    const auto busy_start = clock::now();
+                    if (streaming) {
+                        downloader_->streamUnit(units[i]);
+                        fetch_stats.add_busy(clock::now() - busy_start);
+                        fetch_stats.add_items(1);
+                        continue;
+                    }
+                    auto archive = downloader_->fetchUnit(units[i]);
+                    const auto idle_start = clock::now();
+                    fetch_stats.add_busy(idle_start - busy_start);
+                    fetch_stats.add_items(1);
+                    // blocks while the parse stage is prefetch archives behind
+                    if (archive.has_value() && !fetched.push(std::move(*archive))) {
+                        return;
+                    }
+                    fetch_stats.add_idle(clock::now() - idle_start);
+                } catch (const std::exception &e) {
+                    std::cerr << "Error processing " << units[i].url << ": " << e.what() << std::endl;
+                }
+            }
+        };
+
+        auto parse_worker = [&]() {
+            while (true) {
+                const auto idle_start = clock::now();
+                auto archive = fetched.pop();
+                const auto busy_start = clock::now();
+                parse_stats.add_idle(busy_start - idle_start);
+                if (!archive.has_value()) {
+                    return;
+                }
+                try {
+                    downloader_->parseUnit(*archive);
+                } catch (const std::exception &e) {
+                    std::cerr << "Error parsing " << archive->unit.url << ": " << e.what() << std::endl;
+                }
+                parse_stats.add_busy(clock::now() - busy_start);
+                parse_stats.add_items(1);
+            }
+        };
+
+        const auto fetch_threads = std::min(settings_->parallelism, std::max<size_t>(units.size(), 1));
+        const auto parse_threads = streaming ? 0 : std::min(settings_->parseWorkers, std::max<size_t>(units.size(), 1));
+        std::vector<std::thread> parsers;
+        parsers.reserve(parse_threads);
+        for (size_t i = 0; i < parse_threads; ++i) {
+            parsers.emplace_back(parse_worker);
+        }
+        std::vector<std::thread> fetchers;
+        fetchers.reserve(fetch_threads);
+        for (size_t i = 0; i < fetch_threads; ++i) {
+            fetchers.emplace_back(fetch_worker);
+        }
+
+        for (auto &fetcher : fetchers) {
+            fetcher.join();
+        }
+        // parsers drain what was prefetched, then see the closed queue and exit
+        fetched.close();
+        for (auto &parser : parsers) {
+            parser.join();
+        }
+        context_->producerDone.store(true);
+    }
+
+    void HistoricalDataProcessor::reportConnections(const std::vector<writer::ConnectionStats> &previous,
+        const std::vector<writer::ConnectionStats> &latest, const double seconds) {
+        for (size_t i = 0; i < latest.size(); ++i) {
+            const auto rows = latest[i].rows - (i < previous.size() ? previous[i].rows : 0);
+            const auto bytes = latest[i].bytes - (i < previous.size() ? previous[i].bytes : 0);
+            std::cout << "INFO::HistoricalDataProcessor connection " << i
+                      << " rows=" << latest[i].rows
+                      << std::fixed << std::setprecision(1)
+                      << " rows/s=" << (seconds > 0.0 ? static_cast<double>(rows) / seconds : 0.0)
+                      << " MB/s=" << (seconds > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0)
+                      << " flush_kb=" << latest[i].flushBytes / 1024;
+            if (const auto &spool = latest[i].spool; spool.spooled > 0) {
+                std::cout << " spooled=" << spool.records << " (" << spool.bytes / 1024 << " KB, " << spool.dropped << " dropped)";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    void HistoricalDataProcessor::reportStage(const StageStats &stats, const size_t threads) {
+        std::cout << "INFO::HistoricalDataProcessor stage " << std::left << std::setw(12) << stats.name() << std::right
+                  << " threads=" << threads
+                  << " items=" << stats.items()
+                  << std::fixed << std::setprecision(1)
+                  << " busy=" << stats.utilisation() * 100.0 << "%"
+                  << " (" << stats.busy_seconds() << " s busy, " << stats.idle_seconds() << " s idle)" << std::endl;
     }
 }
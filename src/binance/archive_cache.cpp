@@ -0,0 +1,171 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "binancehistoricaldatafetcher/archive_cache.h"
+
+namespace downloader {
+
+    ArchiveCache::ArchiveCache(const std::filesystem::path &root, const uint64_t max_bytes) :
+        root_(root),
+        objects_dir_(root / "objects"),
+        refs_dir_(root / "refs"),
+        staging_dir_(root / "staging"),
+        max_bytes_(max_bytes) {
+        std::filesystem::create_directories(objects_dir_);
+        std::filesystem::create_directories(refs_dir_);
+        // anything left in staging is from an interrupted run and was never verified
+        std::filesystem::remove_all(staging_dir_);
+        std::filesystem::create_directories(staging_dir_);
+    }
+
+    std::string ArchiveCache::archive_key(const std::string &url) {
+        // strip scheme and host: https://data.binance.vision/data/futures/... -> data/futures/...
+        auto start = url.find("://");
+        start = start == std::string::npos ? 0 : url.find('/', start + 3);
+        if (start == std::string::npos) {
+            return url;
+        }
+        return url.substr(start + 1);
+    }
+
+    std::optional<std::string> ArchiveCache::parse_checksum(const std::string &body) {
+        const auto end = body.find_first_of(" \t\r\n");
+        auto digest = body.substr(0, end);
+        if (digest.size() != 64 || !std::ranges::all_of(digest, [](const unsigned char c) { return std::isxdigit(c); })) {
+            return std::nullopt;
+        }
+        std::ranges::transform(digest, digest.begin(), [](const unsigned char c) { return std::tolower(c); });
+        return digest;
+    }
+
+    std::optional<std::filesystem::path> ArchiveCache::lookup(const std::string &url) {
+        std::lock_guard lock(mutex_);
+        const auto ref = ref_path(url);
+        std::ifstream ref_file(ref);
+        std::string digest;
+        if (!ref_file.is_open() || !(ref_file >> digest)) {
+            return std::nullopt;
+        }
+        const auto object = objects_dir_ / (digest + ".zip");
+        std::error_code ec;
+        if (!std::filesystem::exists(object, ec)) {
+            // object was evicted, drop the dangling ref
+            std::filesystem::remove(ref, ec);
+            return std::nullopt;
+        }
+        // mtime doubles as the LRU clock
+        std::filesystem::last_write_time(object, std::filesystem::file_time_type::clock::now(), ec);
+        ++pins_[object.filename().string()];
+        return object;
+    }
+
+    std::filesystem::path ArchiveCache::staging_path(const std::string &url) const {
+        static std::atomic<uint64_t> sequence{0};
+        const auto name = std::filesystem::path(url).filename().string();
+        const auto id = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        return staging_dir_ / (std::to_string(id) + "-" + std::to_string(sequence.fetch_add(1)) + "-" + name + ".part");
+    }
+
+    std::optional<std::filesystem::path> ArchiveCache::commit(const std::string &url,
+        const std::filesystem::path &staged_file,
+        const std::string &actual_sha256,
+        const std::string &expected_sha256) {
+        std::error_code ec;
+        if (actual_sha256 != expected_sha256) {
+            std::cerr << "ERROR::ArchiveCache::commit checksum mismatch for " << url
+                      << " expected " << expected_sha256 << " got " << actual_sha256 << std::endl;
+            std::filesystem::remove(staged_file, ec);
+            return std::nullopt;
+        }
+
+        std::lock_guard lock(mutex_);
+        const auto object = objects_dir_ / (expected_sha256 + ".zip");
+        if (std::filesystem::exists(object, ec)) {
+            std::filesystem::remove(staged_file, ec);
+        } else {
+            std::filesystem::rename(staged_file, object, ec);
+            if (ec) {
+                std::cerr << "ERROR::ArchiveCache::commit failed to store " << url << ": " << ec.message() << std::endl;
+                std::filesystem::remove(staged_file, ec);
+                return std::nullopt;
+            }
+        }
+
+        // write the ref via rename so a crash never leaves a half written digest behind
+        const auto ref = ref_path(url);
+        std::filesystem::create_directories(ref.parent_path());
+        const auto tmp_ref = std::filesystem::path(ref.string() + ".tmp");
+        {
+            std::ofstream ref_file(tmp_ref, std::ios::trunc);
+            ref_file << expected_sha256 << '\n';
+        }
+        std::filesystem::rename(tmp_ref, ref, ec);
+
+        // pinned before evicting, so the object just committed is never the one removed
+        ++pins_[object.filename().string()];
+        evict();
+        return object;
+    }
+
+    void ArchiveCache::release(const std::filesystem::path &object) {
+        std::lock_guard lock(mutex_);
+        const auto pin = pins_.find(object.filename().string());
+        if (pin == pins_.end()) {
+            return;
+        }
+        if (--pin->second == 0) {
+            pins_.erase(pin);
+            // an object kept past max_bytes while pinned goes now
+            evict();
+        }
+    }
+
+    std::filesystem::path ArchiveCache::ref_path(const std::string &url) const {
+        return refs_dir_ / (archive_key(url) + ".sha256");
+    }
+
+    void ArchiveCache::evict() {
+        struct Entry {
+            std::filesystem::path path;
+            std::filesystem::file_time_type last_used;
+            uint64_t size;
+        };
+        std::vector<Entry> entries;
+        uint64_t total = 0;
+        std::error_code ec;
+        for (const auto &entry : std::filesystem::directory_iterator(objects_dir_, ec)) {
+            const auto size = entry.file_size(ec);
+            if (ec) {
+                continue;
+            }
+            total += size;
+            // pinned objects count against max_bytes but are not candidates
+            if (!pins_.contains(entry.path().filename().string())) {
+                entries.push_back(Entry{entry.path(), entry.last_write_time(ec), size});
+            }
+        }
+        if (total <= max_bytes_) {
+            return;
+        }
+        std::ranges::sort(entries, {}, &Entry::last_used);
+        for (const auto &[path, last_used, size] : entries) {
+            if (total <= max_bytes_) {
+                break;
+            }
+            // refs to this object are cleaned up lazily by lookup
+            if (std::filesystem::remove(path, ec)) {
+                total -= size;
+                std::cout << "INFO::ArchiveCache::evict evicted " << path.filename() << " (" << size << " bytes)" << std::endl;
+            }
+        }
+    }
+}
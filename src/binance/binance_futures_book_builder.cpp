@@ -10,6 +10,7 @@
 
 #include "binancehistoricaldatafetcher/binance_futures_book_builder.h"
 #include "binancehistoricaldatafetcher/binance_futures_orderbook_snapshots_socket_client.h"
+#include "common/sync/event_batcher.h"
 
 namespace binance::processor {
 
@@ -24,9 +25,16 @@ namespace binance::processor {
         order_books_->init(symbols_);
         // start threads to process updates
         is_running_ = true;
-        for (const auto &symbol : symbols_) {
+        for (const auto symbol : symbols_) {
+            // every builder thread publishes from a pool of its own
+            auto &pool = snapshot_pools_.emplace_back(SnapshotPool::create(
+                SNAPSHOT_POOL_PREWARM,
+                [](OrderbookSnapshot &snapshot) {
+                    snapshot.bids.reserve(SNAPSHOT_POOL_LEVELS);
+                    snapshot.asks.reserve(SNAPSHOT_POOL_LEVELS);
+                }));
             // start thread and add to vector
-            builder_threads_.emplace_back(&BinanceFuturesBookBuilder::build_book, this, symbol);
+            builder_threads_.emplace_back(&BinanceFuturesBookBuilder::build_book, this, symbol, pool.get());
         }
     }
 
@@ -36,6 +44,15 @@ namespace binance::processor {
         for (auto &thread : builder_threads_) {
             thread.join();
         }
+        std::cout << "INFO::BinanceFuturesBookBuilder::stop pooled message allocations: " << pool_allocations() << "\n";
+    }
+
+    uint64_t BinanceFuturesBookBuilder::pool_allocations() const {
+        uint64_t allocations = socket_client_->pool_allocations();
+        for (const auto &pool : snapshot_pools_) {
+            allocations += pool->allocations();
+        }
+        return allocations;
     }
 
     // get a snapshot for each symbol
@@ -43,34 +60,37 @@ namespace binance::processor {
     // DataEvent
     void BinanceFuturesBookBuilder::get_snapshots() const {
         std::vector<DataEvent> snapshots;
-        for (const auto &symbol : symbols_) {
-            DataEvent event;
-            auto snapshot = order_books_->get_snapshot(symbol, depth_);
-            event.orderbook_snapshot = snapshot;
-            snapshots.emplace_back(event);
+        snapshots.reserve(symbols_.size());
+        for (const auto symbol : symbols_) {
+            snapshots.emplace_back(std::make_unique<OrderbookSnapshot>(order_books_->get_snapshot(symbol, depth_)));
         }
-        event_queue_.enqueue_bulk(snapshots.data(), snapshots.size());
+        event_queue_.enqueue_bulk(snapshots.begin(), snapshots.size());
+        events_ready_->notify();
     }
 
-    void BinanceFuturesBookBuilder::build_book(const std::string &symbol) const {
+    void BinanceFuturesBookBuilder::build_book(const types::Symbol symbol, SnapshotPool *pool) const {
+        common::sync::EventBatcher<DataEvent> batcher(event_queue_, batch_size_, batch_timeout_, events_ready_);
+        common::sync::WaitStrategy wait(wait_options_);
+        std::vector<DepthUpdate> updates;
         while (is_running_) {
-            auto updates = order_books_->deque_update(symbol);
-            if (!updates.has_value()) {
+            if (order_books_->drain_updates(symbol, updates) == 0) {
+                batcher.poll();
+                wait.idle();
                 continue;
             }
-            for (const auto &update : updates.value()) {
-                auto res = order_books_->process_update(update);
+            wait.reset();
+            for (const auto &update : updates) {
+                auto res = order_books_->process_update(*update);
                 if (res == -1) {
                     // get fresh snapshot and re-init
-                    std::cout << "WARN::BinanceFuturesBookBuilder::build_book Re-initializing order book for symbol: " << symbol << "\n";
+                    std::cout << "WARN::BinanceFuturesBookBuilder::build_book Re-initializing order book for symbol: " << order_books_->reference_data().name(symbol) << "\n";
                     order_books_->init_order_book(symbol);
                     break;
                 }
                 // publish update event
-                DataEvent event;
-                event.orderbook_snapshot = order_books_->get_snapshot(symbol, depth_);
-                event_queue_.enqueue(event);
-                std::cout << "INFO::BinanceFuturesBookBuilder::build_book Published update for symbol: " << symbol << "\n";
+                auto snapshot = pool->acquire();
+                order_books_->fill_snapshot(symbol, depth_, *snapshot);
+                batcher.push(DataEvent(std::move(snapshot)));
             }
         }
     }
@@ -2,7 +2,6 @@
 // Created by jtwears on 10/5/25.
 //
 #include <string>
-#include <algorithm>
 #include <nlohmann/json.hpp>
 
 #include "binancehistoricaldatafetcher/binance_futures_orderbook_snapshots_socket_client.h"
@@ -12,8 +11,12 @@ namespace downloader {
     using json = nlohmann::json;
 
     void BinanceFuturesOrderbookSnapshotsSocketClient::on_message(websocketpp::connection_hdl, const client::message_ptr msg) {
-        auto event = msg->get_payload();
-        const auto snapshot = json::parse(event);
+        on_payload(msg->get_payload());
+    }
+
+    void BinanceFuturesOrderbookSnapshotsSocketClient::on_payload(const std::string &payload) {
+        // the json DOM still allocates per message, a couple of hundred times for depth20, see bench/depth_update_alloc_bench
+        const auto snapshot = json::parse(payload);
         [[unlikely]] if (!snapshot.contains("data")) {
             // No event type; ignore
             std::cout << "INFO::BinanceFuturesOrderbookSnapshotsSocketClient::on_message Ignoring message with no event type: " << snapshot.dump() << std::endl;
@@ -25,51 +28,68 @@ namespace downloader {
             std::cout << "INFO::BinanceFuturesOrderbookSnapshotsSocketClient::on_message Ignoring non-depthUpdate message: " << snapshot.dump() << std::endl;
             return;
         }
-        std::cout << "INFO::BinanceFuturesOrderbookSnapshotsSocketClient::on_message Received depth update message: " << snapshot.dump() << std::endl;
-        BinanceFuturesSocketDepthSnapshot snapshot_data;
-        from_json(snapshot["data"], snapshot_data);
-        if (const auto symbol_buffer = event_queues_.find(snapshot_data.symbol); symbol_buffer != event_queues_.end()) {
-            symbol_buffer->second->enqueue(snapshot_data);
+        auto update = depth_pool_->acquire();
+        if (!from_json(snapshot["data"], *update)) {
+            std::cerr << "ERROR::BinanceFuturesOrderbookSnapshotsSocketClient::on_message Dropping depth update with an unknown symbol or malformed price levels\n";
+            return;
+        }
+        const auto symbol = update->symbol;
+        if (symbol < event_queues_.size() && event_queues_[symbol] != nullptr) {
+            // the gap this leaves is caught by the book's update id check, which resyncs from a snapshot
+            [[unlikely]] if (!event_queues_[symbol]->try_push(std::move(update))) {
+                std::cerr << "WARN::BinanceFuturesOrderbookSnapshotsSocketClient::on_message depth queue full, dropping update for "
+                          << reference_data_->name(symbol) << "\n";
+            }
         } else {
-            std::cout << "No queue found for symbol: " << snapshot_data.symbol << std::endl;
+            std::cout << "No queue found for symbol: " << reference_data_->name(symbol) << std::endl;
             throw std::runtime_error("No queue found for symbol");
         }
     }
 
-    void BinanceFuturesOrderbookSnapshotsSocketClient::from_json(const nlohmann::json &j, BinanceFuturesSocketDepthSnapshot &snapshot) const {
-        auto order_book_symbol = j["s"].get<std::string>();
-        std::ranges::transform(order_book_symbol, order_book_symbol.begin(),::tolower);
-        snapshot.symbol = order_book_symbol;
+    bool BinanceFuturesOrderbookSnapshotsSocketClient::from_json(const nlohmann::json &j, BinanceFuturesSocketDepthSnapshot &snapshot) const {
+        // the only string lookup of the update, everything downstream indexes by the id
+        const auto symbol = reference_data_->find(j.at("s").get_ref<const std::string &>());
+        if (!symbol.has_value()) {
+            return false;
+        }
+        snapshot.symbol = *symbol;
         j.at("e").get_to(snapshot.event_type);
         j.at("E").get_to(snapshot.event_time);
         j.at("T").get_to(snapshot.transaction_time);
         j.at("U").get_to(snapshot.first_update_id);
         j.at("u").get_to(snapshot.final_update_id);
         j.at("pu").get_to(snapshot.previous_final_update_id);
-        std::vector<PriceLevel> bids;
-        std::vector<PriceLevel> asks;
+        const auto &price = reference_data_->price_codec(snapshot.symbol);
+        const auto &quantity = reference_data_->quantity_codec(snapshot.symbol);
+        // straight into the (possibly recycled) update, its vectors keep their capacity
+        snapshot.bids.clear();
+        snapshot.asks.clear();
         for (const auto &bid : j["b"]) {
             PriceLevel price_level{};
-            parse_price_levels(bid, price_level, snapshot.symbol);
-            bids.push_back(price_level);
+            if (!parse_price_levels(bid, price_level, price, quantity)) {
+                return false;
+            }
+            snapshot.bids.push_back(price_level);
         }
         for (const auto &ask : j["a"]) {
             PriceLevel price_level{};
-            parse_price_levels(ask, price_level, snapshot.symbol);
-            asks.push_back(price_level);
+            if (!parse_price_levels(ask, price_level, price, quantity)) {
+                return false;
+            }
+            snapshot.asks.push_back(price_level);
         }
-        snapshot.bids = bids;
-        snapshot.asks = asks;
+        return true;
     }
 
-    void BinanceFuturesOrderbookSnapshotsSocketClient::parse_price_levels(const nlohmann::json &j, PriceLevel &price_level, const std::string &symbol) const {
-        if (j.is_array() && j.size() == 2) {
-            auto [tick_size, step_size] = exchange_info_->at(symbol);
-            price_level.price = common::rounding::FixedPoint::from_string(j.at(0).get<std::string>(), tick_size);
-            price_level.quantity = common::rounding::FixedPoint::from_string(j.at(1).get<std::string>(), step_size);
-        } else {
-            throw std::runtime_error("Invalid PriceLevel JSON format");
+    bool BinanceFuturesOrderbookSnapshotsSocketClient::parse_price_levels(const nlohmann::json &j, PriceLevel &price_level,
+                                                                           const common::reference::PriceCodec &price,
+                                                                           const common::reference::PriceCodec &quantity) noexcept {
+        if (!j.is_array() || j.size() != 2 || !j[0].is_string() || !j[1].is_string()) {
+            return false;
         }
+        // parse straight from the json string storage - no copy, no double round trip
+        return price.parse(j[0].get_ref<const std::string &>(), price_level.price)
+            && quantity.parse(j[1].get_ref<const std::string &>(), price_level.quantity);
     }
 
 };
\ No newline at end of file
@@ -16,11 +16,11 @@
 
 namespace binance::models {
 
-    void BinanceFuturesOrderbook::init(const std::vector<std::string>& symbols) {
+    void BinanceFuturesOrderbook::init(const std::vector<types::Symbol>& symbols) {
         std::vector<std::thread> threads;
-        for (const auto& snapshot : symbols) {
-            threads.emplace_back([this, &snapshot]() {
-                this->init_order_book(snapshot);
+        for (const auto symbol : symbols) {
+            threads.emplace_back([this, symbol]() {
+                this->init_order_book(symbol);
             });
         }
         for (auto& thread : threads) {
@@ -30,42 +30,42 @@ namespace binance::models {
         }
     }
 
-    void BinanceFuturesOrderbook::init_order_book(const std::string& symbol) {
+    void BinanceFuturesOrderbook::init_order_book(const types::Symbol symbol) {
+        [[unlikely]] if (!is_tracked(symbol)) {
+            throw std::invalid_argument("Symbol not found in orderbook context");
+        }
         const auto snapshot_ = fetch_snapshot(symbol);
         [[unlikely]] if (!snapshot_.has_value()) {
-            throw std::runtime_error("Failed to get snapshot for symbol: " + symbol);
+            throw std::runtime_error("Failed to get snapshot for symbol: " + reference_data_->name(symbol));
         }
         auto snapshot = snapshot_.value();
-        const auto symbol_context = context_.find(snapshot.symbol);
-        [[unlikely]] if (symbol_context == context_.end()) {
-            throw std::invalid_argument("Symbol not found in orderbook context");
-        }
-
-        while (!symbol_context->second.is_initialized) {
-           auto socket_events = deque_update(snapshot.symbol);
-            if (!socket_events.has_value()) {
+        auto &symbol_context = context_[symbol];
+
+        // the socket feeds the queue while the snapshot request is in flight, back off until it does
+        common::sync::WaitStrategy wait(wait_options_);
+        std::vector<DepthUpdate> valid_events;
+        while (!symbol_context.is_initialized) {
+            if (drain_updates(snapshot.symbol, valid_events) == 0) {
+                wait.idle();
                 continue;
             }
+            wait.reset();
 
             // Drop events with little u less that snapshot lat update id
-            std::vector<BinanceFuturesSocketDepthSnapshot> valid_events;
-            for (const auto &event : socket_events.value()) {
-                if (event.final_update_id < snapshot.lastUpdate_id) {
-                    continue;
-                }
-                valid_events.push_back(event);
-            }
+            std::erase_if(valid_events, [&snapshot](const DepthUpdate &event) {
+                return event->final_update_id < snapshot.lastUpdate_id;
+            });
 
             // first processed event is U <= last_update_id AND u >= last_update_id
             // break after this and set symbol context to initialised true
             for (const auto &event : valid_events) {
-                if (event.first_update_id <= snapshot.lastUpdate_id
-                    && event.final_update_id >= snapshot.lastUpdate_id) {
-                    apply_update(event.symbol, event.bids, true);
-                    apply_update(event.symbol, event.asks, false);
-                    symbol_context->second.last_update_id = event.final_update_id;
-                    symbol_context->second.previous_u = event.final_update_id;
-                    symbol_context->second.is_initialized = true;
+                if (event->first_update_id <= snapshot.lastUpdate_id
+                    && event->final_update_id >= snapshot.lastUpdate_id) {
+                    apply_update(event->symbol, event->bids, true);
+                    apply_update(event->symbol, event->asks, false);
+                    symbol_context.last_update_id = event->final_update_id;
+                    symbol_context.previous_u = event->final_update_id;
+                    symbol_context.is_initialized = true;
                     break;
                 }
                 // hit this snapshot is stale
@@ -82,24 +82,24 @@ namespace binance::models {
      * -1 - Out of sync
      */
     int BinanceFuturesOrderbook::process_update(const BinanceFuturesSocketDepthSnapshot& snapshot) {
-        const auto symbol_context = context_.find(snapshot.symbol);
-        [[unlikely]] if (symbol_context == context_.end()) {
+        [[unlikely]] if (!is_tracked(snapshot.symbol)) {
             throw std::invalid_argument("Symbol not found in orderbook context");
         }
+        auto &symbol_context = context_[snapshot.symbol];
 
-        if (snapshot.previous_final_update_id != symbol_context->second.last_update_id) {
-            symbol_context->second.is_initialized = false;
+        if (snapshot.previous_final_update_id != symbol_context.last_update_id) {
+            symbol_context.is_initialized = false;
             return -1;
         }
 
         apply_update(snapshot.symbol, snapshot.bids, true);
         apply_update(snapshot.symbol, snapshot.asks, false);
-        symbol_context->second.last_update_id = snapshot.final_update_id;
-        symbol_context->second.previous_u = snapshot.final_update_id;
+        symbol_context.last_update_id = snapshot.final_update_id;
+        symbol_context.previous_u = snapshot.final_update_id;
         return 0;
     }
 
-    void BinanceFuturesOrderbook::apply_update(const std::string &symbol, const std::vector<PriceLevel> &price_level, const bool is_bid) {
+    void BinanceFuturesOrderbook::apply_update(const types::Symbol symbol, const std::vector<PriceLevel> &price_level, const bool is_bid) {
         for (const auto &level : price_level) {
             if (level.quantity > 0) {
                 multi_symbol_orderbook_.update_price_level(symbol, level, is_bid);
@@ -109,18 +109,18 @@ namespace binance::models {
         }
     }
 
-    std::optional<BinanceFuturesOrderbookSnapshot> BinanceFuturesOrderbook::fetch_snapshot(const std::string &symbol) const {
+    std::optional<BinanceFuturesOrderbookSnapshot> BinanceFuturesOrderbook::fetch_snapshot(const types::Symbol symbol) const {
         auto depth = std::to_string(depth_);
         const auto response = cpr::Get(cpr::Url{PROD_BINANCE_FUTURES_REST_URL},
-                                       cpr::Parameters{{"symbol", symbol},
+                                       cpr::Parameters{{"symbol", reference_data_->name(symbol)},
                                                        {"limit", depth}});
 
         if (response.status_code != 200) {
             return std::nullopt;
         }
         BinanceFuturesOrderbookSnapshot snapshot;
-        auto [tick_size, step_size] = exchange_info_->at(symbol);
-        models::from_json(nlohmann::json::parse(response.text), snapshot, tick_size, step_size);
+        models::from_json(nlohmann::json::parse(response.text), snapshot,
+            reference_data_->tick_size(symbol), reference_data_->step_size(symbol));
         snapshot.symbol = symbol;
         return snapshot;
     }
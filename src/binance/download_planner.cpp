@@ -0,0 +1,100 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+#include "binancehistoricaldatafetcher/download_planner.h"
+
+namespace downloader {
+
+    namespace {
+        int64_t to_epoch_ms(const std::chrono::sys_days day) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(day.time_since_epoch()).count();
+        }
+
+        std::chrono::sys_days first_of_month(const std::chrono::sys_days day) {
+            const std::chrono::year_month_day ymd(day);
+            return ymd.year() / ymd.month() / std::chrono::day{1};
+        }
+
+        std::chrono::sys_days first_of_next_month(const std::chrono::sys_days day) {
+            const std::chrono::year_month_day ymd(day);
+            return std::chrono::year_month_day(ymd.year() / ymd.month() / std::chrono::day{1}) + std::chrono::months{1};
+        }
+    }
+
+    std::vector<ArchivePeriod> plan_archives(
+        const std::chrono::year_month_day start,
+        const std::chrono::year_month_day end,
+        const DownloadType download_type) {
+        const std::chrono::sys_days range_start(start);
+        const std::chrono::sys_days range_end(end);
+        const int64_t range_from_ms = to_epoch_ms(range_start);
+        const int64_t range_to_ms = to_epoch_ms(range_end);
+
+        std::vector<ArchivePeriod> periods;
+        auto current = range_start;
+        while (current < range_end) {
+            const auto month_start = first_of_month(current);
+            const auto month_end = first_of_next_month(current);
+            const bool whole_month = current == month_start && month_end <= range_end;
+
+            if (download_type == common::models::enums::MONTHLY
+                || (download_type == common::models::enums::AUTO && whole_month)) {
+                periods.push_back(ArchivePeriod{
+                    common::models::enums::MONTHLY,
+                    format_month(std::chrono::year_month_day(month_start)),
+                    std::max(range_from_ms, to_epoch_ms(month_start)),
+                    std::min(range_to_ms, to_epoch_ms(month_end)),
+                });
+                current = month_end;
+            } else {
+                const auto next_day = current + std::chrono::days{1};
+                periods.push_back(ArchivePeriod{
+                    common::models::enums::DAILY,
+                    format_date(std::chrono::year_month_day(current)),
+                    to_epoch_ms(current),
+                    to_epoch_ms(next_day),
+                });
+                current = next_day;
+            }
+        }
+        return periods;
+    }
+
+    std::chrono::year_month_day parse_date(const std::string &date) {
+        std::stringstream ss(date);
+        int year, month, day;
+
+        if (char dash; !(ss >> year >> dash >> month >> dash >> day)) {
+            throw std::invalid_argument("Invalid date format. Expected YYYY-MM-DD.");
+        }
+        const auto ymd = std::chrono::year_month_day(
+            std::chrono::year(year),
+            std::chrono::month(month),
+            std::chrono::day(day)
+        );
+        if (!ymd.ok()) {
+            throw std::invalid_argument("Invalid date: " + date);
+        }
+        return ymd;
+    }
+
+    std::string format_date(const std::chrono::year_month_day date) {
+        char buffer[16];
+        std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02u",
+            static_cast<int>(date.year()), static_cast<unsigned>(date.month()), static_cast<unsigned>(date.day()));
+        return buffer;
+    }
+
+    std::string format_month(const std::chrono::year_month_day date) {
+        char buffer[16];
+        std::snprintf(buffer, sizeof(buffer), "%04d-%02u",
+            static_cast<int>(date.year()), static_cast<unsigned>(date.month()));
+        return buffer;
+    }
+}
@@ -9,28 +9,60 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
-
-#include <cpr/cpr.h>
-#include <elzip/elzip.hpp>
+#include <algorithm>
+#include <iterator>
+#include <utility>
 
 #include "binancehistoricaldatafetcher/file_downloader.h"
+#include "binancehistoricaldatafetcher/download_planner.h"
 #include "binancehistoricaldatafetcher/HistoricalDataProcessor.h"
 #include "binancehistoricaldatafetcher/binance_market_data_models.h"
+#include "common/crypto/sha256.h"
+#include "common/io/zip_stream.h"
+#include "common/parsing/csv_tokenizer.h"
+#include "common/parsing/number_parser.h"
+#include "common/parsing/parallel_csv_parser.h"
+#include "common/rounding/fixed_point.h"
 
 namespace downloader {
 
+    namespace {
+        // exact when the value fits the codec's scale; a finer one is rounded and flagged rather than losing the row
+        bool parse_value(const common::reference::PriceCodec &codec, const std::string_view field, int64_t &out, bool &rounded) {
+            if (codec.parse(field, out)) {
+                return true;
+            }
+            rounded = true;
+            return codec.parse_rounded(field, out);
+        }
+    }
+
     FileDownloader::FileDownloader(
         const DataType dataType,
         const Product productType,
         const DownloadType downloadType,
-        moodycamel::ConcurrentQueue<DataEvent> &queue,
-        std::shared_ptr<Context> &context) :
+        common::sync::BoundedQueue<DataEvent> &queue,
+        std::shared_ptr<Context> &context,
+        const std::shared_ptr<const common::reference::ReferenceDataService> &referenceData,
+        const bool streaming,
+        const std::shared_ptr<ArchiveCache> &cache,
+        const HttpFetcherOptions &fetch_options,
+        const std::shared_ptr<common::io::JobManifest> &manifest,
+        const size_t parseThreads,
+        const size_t batchRows) :
         queue_(queue),
         context_(context),
+        reference_data_(referenceData),
         tmp_dir_(std::filesystem::temp_directory_path()),
         data_type_(dataType),
         product_type_(productType),
-        download_type_(downloadType) {
+        download_type_(downloadType),
+        streaming_(streaming),
+        cache_(cache),
+        fetcher_(fetch_options),
+        manifest_(manifest),
+        parse_threads_(std::max<size_t>(parseThreads, 1)),
+        batch_rows_(std::max<size_t>(batchRows, 1)) {
 
         const auto tm_dir_path = tmp_dir_ / "tmp-historical-binance-data";
         if (!std::filesystem::exists(tm_dir_path)) {
@@ -45,256 +77,378 @@ namespace downloader {
         }
     }
 
-    void FileDownloader::download(const std::vector<std::string> &symbols, const std::string &start_date, const std::string &end_date) const {
-        for (const std::string& symbol : symbols) {
-            for (const std::vector<std::string> urls = createUrls(symbol, start_date, end_date); const auto &url : urls) {
-                if (downloadFile(url)) {
-                    if (unzipFile()) {
-                        if (data_type_ == TRADES) {
-                            readFuturesTradeFile(url, symbol);
-                        } else if (data_type_ == OHLCV) {
-                            readCandleFile(url, symbol);
-                        } else {
-                            deleteFile();
-                            break;
-                        }
-                    }
-                    deleteFile();
+    std::vector<DownloadUnit> FileDownloader::pendingUnits(const std::vector<std::string> &symbols, const std::string &start_date, const std::string &end_date) const {
+        std::vector<DownloadUnit> units = plan(symbols, start_date, end_date);
+        if (manifest_) {
+            // units acknowledged by the writer in an earlier run are already in the sink
+            const auto planned = units.size();
+            std::erase_if(units, [this](const DownloadUnit &unit) { return manifest_->is_complete(unit.url); });
+            for (const auto &unit : units) {
+                manifest_->record(unit.url, common::io::UnitState::PLANNED);
+            }
+            manifest_->sync();
+            std::cout << "INFO::FileDownloader::pendingUnits skipping " << planned - units.size()
+                      << " units completed by a previous run" << std::endl;
+        }
+        return units;
+    }
+
+    auto FileDownloader::makeRowParser(const DownloadUnit &unit, RowIssues &issues) const {
+        return common::parsing::make_parallel_csv_parser<CSV_MAX_FIELDS, std::vector<DataEvent>>(
+            parse_threads_,
+            common::parsing::DEFAULT_PARSE_SLICE_SIZE,
+            [this, &unit, &issues](const CsvRow fields, std::vector<DataEvent> &blocks) {
+                // rows go into blocks of batch_rows_, only the last block of a slice can be short
+                if (blocks.empty() || blocks.back().rows() >= batch_rows_) {
+                    blocks.emplace_back();
                 }
-                break;
+                parseRow(fields, unit, blocks.back(), issues);
+            },
+            [this](std::vector<DataEvent> &blocks) {
+                if (!blocks.empty() && blocks.back().type() == EventType::EMPTY) {
+                    blocks.pop_back();
+                }
+                // the queue moves a single pointer per block of rows
+                queue_.enqueue_bulk(blocks.begin(), blocks.size());
+                context_->dataReady.notify();
+            });
+    }
+
+    std::optional<FetchedArchive> FileDownloader::fetchUnit(const DownloadUnit &unit) const {
+        if (cache_) {
+            if (const auto cached = cache_->lookup(unit.url)) {
+                // cache hits skip the network entirely
+                std::cout << "Cache hit for " << unit.url << std::endl;
+                recordState(unit, common::io::UnitState::DOWNLOADED);
+                return FetchedArchive{unit, *cached, false};
+            }
+            if (const auto expected_sha256 = fetchChecksum(unit.url)) {
+                const auto staged = cache_->staging_path(unit.url);
+                common::crypto::Sha256 hasher;
+                if (!downloadFile(unit.url, staged, &hasher)) {
+                    std::error_code ec;
+                    std::filesystem::remove(staged, ec);
+                    return std::nullopt;
+                }
+                const auto object = cache_->commit(unit.url, staged, hasher.hex_digest(), *expected_sha256);
+                if (!object.has_value()) {
+                    return std::nullopt;
+                }
+                recordState(unit, common::io::UnitState::DOWNLOADED);
+                return FetchedArchive{unit, *object, false};
             }
         }
-        context_->producerDone.store(true);
+        // every fetched archive gets its own scratch file, several can wait for the parse stage at once
+        const auto scratch = tmp_dir_file_ / ("unit-" + std::to_string(next_scratch_id_.fetch_add(1)) + ".zip");
+        if (!downloadFile(unit.url, scratch, nullptr)) {
+            std::error_code ec;
+            std::filesystem::remove(scratch, ec);
+            return std::nullopt;
+        }
+        recordState(unit, common::io::UnitState::DOWNLOADED);
+        return FetchedArchive{unit, scratch, true};
     }
 
-    bool FileDownloader::downloadFile(const std::string &url) const {
-        const auto file_path = tmp_dir_file_ / "data.zip";
-        std::ofstream file(file_path, std::ios::binary);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file " << file_path << std::endl;
-            return false;
+    void FileDownloader::parseUnit(const FetchedArchive &archive) const {
+        const bool parsed = parseArchiveFile(archive.path, archive.unit);
+        if (archive.scratch) {
+            std::error_code ec;
+            std::filesystem::remove(archive.path, ec);
+        } else if (cache_) {
+            cache_->release(archive.path);
+        }
+        if (parsed) {
+            completeUnit(archive.unit);
         }
+    }
+
+    void FileDownloader::streamUnit(const DownloadUnit &unit) const {
+        std::optional<std::string> expected_sha256;
+        if (cache_) {
+            if (const auto cached = cache_->lookup(unit.url)) {
+                std::cout << "Cache hit for " << unit.url << std::endl;
+                recordState(unit, common::io::UnitState::DOWNLOADED);
+                const bool parsed = parseArchiveFile(*cached, unit);
+                cache_->release(*cached);
+                if (parsed) {
+                    completeUnit(unit);
+                }
+                return;
+            }
+            expected_sha256 = fetchChecksum(unit.url);
+        }
+        // download and parse overlap, so the unit jumps straight to PARSED
+        if (streamFile(unit, expected_sha256)) {
+            completeUnit(unit);
+        }
+    }
 
-        auto write_callback = [&](const std::string_view data, intptr_t) {
-            file.write(data.data(), data.size());
-            return true;
+    void FileDownloader::completeUnit(const DownloadUnit &unit) const {
+        if (!manifest_) {
+            return;
+        }
+        recordState(unit, common::io::UnitState::PARSED);
+        // the writer marks the unit FLUSHED once everything ahead of this marker has been flushed
+        queue_.enqueue(DataEvent(std::make_unique<UnitComplete>(UnitComplete{unit.url, unit.symbol_id})));
+        context_->dataReady.notify();
+    }
+
+    void FileDownloader::recordState(const DownloadUnit &unit, const common::io::UnitState state) const {
+        if (manifest_) {
+            manifest_->record(unit.url, state);
+        }
+    }
+
+    bool FileDownloader::streamFile(const DownloadUnit &unit, const std::optional<std::string> &expected_sha256) const {
+        // http body -> inflate -> csv tokenizer -> row parser, all on the transfer thread
+        // nothing hits disk unless the archive cache is enabled
+        RowIssues issues;
+        auto rows = makeRowParser(unit, issues);
+        common::io::ZipInflateStream inflater([&](const std::string_view chunk) {
+            rows.feed(chunk);
+        });
+
+        // with the cache enabled the compressed bytes are teed into staging and hashed on the fly
+        std::filesystem::path staged;
+        std::ofstream staged_file;
+        common::crypto::Sha256 hasher;
+        if (expected_sha256.has_value()) {
+            staged = cache_->staging_path(unit.url);
+            staged_file.open(staged, std::ios::binary);
+        }
+        auto discard_staged = [&] {
+            if (!staged.empty()) {
+                staged_file.close();
+                std::error_code ec;
+                std::filesystem::remove(staged, ec);
+            }
         };
 
-        if (const cpr::Response r = cpr::Get(cpr::Url{url}, cpr::WriteCallback{write_callback}); r.error) {
-            std::cerr << "Error downloading file from " << url << ": " << r.error.message << std::endl;
+        uint64_t bytes = 0;
+        const bool fetched = fetcher_.fetch(unit.url, [&](const std::string_view data) {
+            if (staged_file.is_open()) {
+                staged_file.write(data.data(), static_cast<std::streamsize>(data.size()));
+                hasher.update(data);
+            }
+            // returning false aborts the transfer - corrupt archives stop here
+            return inflater.feed(data);
+        }, bytes);
+        bytes_downloaded_.fetch_add(bytes);
+        const bool inflated = fetched && inflater.finish();
+        if (!inflated) {
+            discard_staged();
+        }
+        if (!fetched) {
+            std::cerr << "Error streaming file from " << unit.url
+                      << (inflater.error().empty() ? "" : ": " + inflater.error()) << std::endl;
+            return false;
+        }
+        if (!inflated) {
+            std::cerr << "Error inflating file from " << unit.url << ": " << inflater.error() << std::endl;
+            return false;
+        }
+        rows.finish();
+        reportRowIssues(unit, issues);
+        if (staged_file.is_open()) {
+            staged_file.close();
+            // parsing already happened on the fly, nothing reads the object now
+            if (const auto object = cache_->commit(unit.url, staged, hasher.hex_digest(), *expected_sha256)) {
+                cache_->release(*object);
+            }
+        }
+        std::cout << "Streamed file from " << unit.url << " (" << bytes << " bytes compressed, "
+                  << inflater.bytes_out() << " bytes csv)" << std::endl;
+        return true;
+    }
+
+    bool FileDownloader::downloadFile(const std::string &url, const std::filesystem::path &file_path, common::crypto::Sha256 *hasher) const {
+        uint64_t bytes = 0;
+        const bool ok = fetcher_.fetch_to_file(url, file_path, hasher, bytes);
+        bytes_downloaded_.fetch_add(bytes);
+        if (!ok) {
+            std::cerr << "Error downloading file from " << url << std::endl;
             return false;
         }
         std::cout << "Downloaded file from " << url << " to " << file_path << std::endl;
         return true;
     }
 
-     bool FileDownloader::unzipFile() const {
-        auto zip_path = tmp_dir_file_ / "data.zip";
+    std::optional<std::string> FileDownloader::fetchChecksum(const std::string &url) const {
+        const auto body = fetcher_.fetch_text(url + ".CHECKSUM");
+        if (!body.has_value()) {
+            std::cerr << "WARN::FileDownloader::fetchChecksum no checksum for " << url << ", archive will not be cached" << std::endl;
+            return std::nullopt;
+        }
+        return ArchiveCache::parse_checksum(*body);
+    }
 
-        try {
-            elz::extractZip(tmp_dir_file_);
-            return true;
+    bool FileDownloader::parseArchiveFile(const std::filesystem::path &archive, const DownloadUnit &unit) const {
+        std::ifstream file(archive, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open file " << archive << std::endl;
+            return false;
         }
-        catch (const elz::zip_exception& e) {
-            std::cerr << "Failed to extract zip file from " << tmp_dir_file_ << std::endl;
+        RowIssues issues;
+        auto rows = makeRowParser(unit, issues);
+        common::io::ZipInflateStream inflater([&](const std::string_view chunk) {
+            rows.feed(chunk);
+        });
+        std::vector<char> chunk(CSV_READ_CHUNK_SIZE);
+        while (file) {
+            file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            const auto n = file.gcount();
+            if (n > 0 && !inflater.feed(std::string_view(chunk.data(), static_cast<size_t>(n)))) {
+                break;
+            }
+        }
+        if (!inflater.finish()) {
+            std::cerr << "Error inflating " << archive << ": " << inflater.error() << std::endl;
             return false;
         }
+        rows.finish();
+        reportRowIssues(unit, issues);
+        return true;
     }
 
-    void FileDownloader::readFuturesTradeFile(const std::string& url, const std::string& symbol) const {
-        // get file name - final part of url - remove .zip and replace with .csv
-        const auto file_name_start = url.find_last_of('/') + 1;
-        const auto file_name_end = url.find(".zip");
-        const auto file_name = url.substr(file_name_start, file_name_end - file_name_start) + ".csv";
-        const auto file_path = tmp_dir_file_ / "data" / file_name;
+    void FileDownloader::reportRowIssues(const DownloadUnit &unit, const RowIssues &issues) {
+        const auto rounded = issues.rounded.load(std::memory_order_relaxed);
+        const auto rejected = issues.rejected.load(std::memory_order_relaxed);
+        if (rounded == 0 && rejected == 0) {
+            return;
+        }
+        std::cerr << "WARN::FileDownloader " << unit.url << ": " << rounded << " rows rounded to the archive scale, "
+                  << rejected << " malformed rows skipped" << std::endl;
+    }
 
-        std::ifstream file(file_path);
+    bool FileDownloader::isHeaderRow(const CsvRow fields) {
+        // older archives have no header row, newer ones start with the column names
+        return !fields.empty() && !fields[0].empty() && !std::isdigit(static_cast<unsigned char>(fields[0].front()));
+    }
 
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file " << file_path << std::endl;
+    void FileDownloader::parseRow(const CsvRow fields, const DownloadUnit &unit, DataEvent &batch, RowIssues &issues) const {
+        // slices are parsed independently, so any row may be the first one of the file
+        if (isHeaderRow(fields)) {
             return;
         }
-        // skip the header line
-        std::string line;
-        std::getline(file, line);
-        // structure
-        // 0 - id, 1 - price, 2 - qty, 3 - quoteQty, 4 - time, 5 - isBuyerMaker
-        while (std::getline(file, line)) {
-            std::istringstream ss(line);
-            try {
-                std::string token;
-                Trade trade;
-                // id
-                std::getline(ss, token, ',');
-                trade.id = std::stoll(token);
-                // price
-                std::getline(ss, token, ',');
-                trade.price = std::stod(token);
-                // qty
-                std::getline(ss, token, ',');
-                trade.qty = std::stod(token);
-                // quoteQty
-                std::getline(ss, token, ',');
-                trade.quote_qty = std::stod(token);
-                // time
-                std::getline(ss, token, ',');
-                trade.time = std::stoll(token);
-                // isBuyerMaker == to Side
-                std::getline(ss, token, ',');
-                const bool is_buyer_maker = (token == "true");
-                trade.side = getTradeSide(is_buyer_maker);
-                trade.symbol =  symbol;
-                trade.product_type = product_type_;
-
-                DataEvent event;
-                event.futures_trade = trade;
-                queue_.enqueue(event);
-            } catch (const std::exception &e) {
-                std::cerr << "Error parsing line: " << line << " - " << e.what() << std::endl;
-            }
+        if (data_type_ == TRADES) {
+            parseTradeRow(fields, unit, batch, issues);
+        } else if (data_type_ == OHLCV) {
+            parseCandleRow(fields, unit, batch, issues);
         }
-        file.close();
     }
 
-    void FileDownloader::readCandleFile(const std::string& url, const std::string& symbol) const {
-        // get file name - final part of url - remove .zip and replace with .csv
-        const auto file_name_start = url.find_last_of('/') + 1;
-        const auto file_name_end = url.find(".zip");
-        const auto file_name = url.substr(file_name_start, file_name_end - file_name_start) + ".csv";
-        const auto file_path = tmp_dir_file_ / "data" / file_name;
-
-        std::ifstream file(file_path);
-
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file " << file_path << std::endl;
+    void FileDownloader::parseTradeRow(const CsvRow fields, const DownloadUnit &unit, DataEvent &batch, RowIssues &issues) const {
+        // structure
+        // 0 - id, 1 - price, 2 - qty, 3 - quoteQty, 4 - time, 5 - isBuyerMaker
+        // exact mantissas at the archive scales, which cover every decimal Binance writes to an archive
+        const auto &price = reference_data_->archive_price_codec(unit.symbol_id);
+        const auto &quantity = reference_data_->archive_quantity_codec(unit.symbol_id);
+        const auto &notional = reference_data_->notional_codec(unit.symbol_id);
+        Trade trade;
+        bool is_buyer_maker = false;
+        bool rounded = false;
+        if (fields.size() < 6
+            || !common::parsing::parse_int64(fields[0], trade.id)
+            || !parse_value(price, fields[1], trade.price, rounded)
+            || !parse_value(quantity, fields[2], trade.qty, rounded)
+            || !parse_value(notional, fields[3], trade.quote_qty, rounded)
+            || !common::parsing::parse_int64(fields[4], trade.time)
+            || !common::parsing::parse_bool(fields[5], is_buyer_maker)) {
+            issues.rejected.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (rounded) {
+            issues.rounded.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (trade.time < unit.from_ms || trade.time >= unit.to_ms) {
             return;
         }
-        // skip the header line
-        std::string line;
-        std::getline(file, line);
+        trade.side = getTradeSide(is_buyer_maker);
+
+        if (batch.type() == EventType::EMPTY) {
+            auto trades = std::make_unique<TradeBatch>();
+            trades->reserve(batch_rows_);
+            trades->symbol = unit.symbol_id;
+            trades->product_type = product_type_;
+            batch = DataEvent(std::move(trades));
+        }
+        batch.trades().push_back(trade);
+    }
+
+    void FileDownloader::parseCandleRow(const CsvRow fields, const DownloadUnit &unit, DataEvent &batch, RowIssues &issues) const {
         // structure
         // 0 - open_time, 1 - open, 2 - high, 3 - low, 4 - close, 5 - volume, 6 - close_time
-        while (std::getline(file, line)) {
-            std::istringstream ss(line);
-            try {
-                std::string token;
-                Candle candle;
-                // open_time
-                std::getline(ss, token, ',');
-                candle.open_time = std::stoll(token);
-                // open
-                std::getline(ss, token, ',');
-                candle.open = std::stod(token);
-                // high
-                std::getline(ss, token, ',');
-                candle.high = std::stod(token);
-                // low
-                std::getline(ss, token, ',');
-                candle.low = std::stod(token);
-                // close
-                std::getline(ss, token, ',');
-                candle.close = std::stod(token);
-                // volume
-                std::getline(ss, token, ',');
-                candle.volume = std::stod(token);
-                // close_time
-                std::getline(ss, token, ',');
-                candle.close_time = std::stoll(token);
-
-                candle.symbol = symbol;
-                candle.product_type = product_type_;
-                candle.frequency = getCandleFrequency(getCandleFrequencyName(
-                        download_type_ == MONTHLY ? ONE_MONTH : ONE_DAY
-                    )
-                );
+        const auto &price = reference_data_->archive_price_codec(unit.symbol_id);
+        const auto &quantity = reference_data_->archive_quantity_codec(unit.symbol_id);
+        Candle candle;
+        bool rounded = false;
+        if (fields.size() < 7
+            || !common::parsing::parse_int64(fields[0], candle.open_time)
+            || !parse_value(price, fields[1], candle.open, rounded)
+            || !parse_value(price, fields[2], candle.high, rounded)
+            || !parse_value(price, fields[3], candle.low, rounded)
+            || !parse_value(price, fields[4], candle.close, rounded)
+            || !parse_value(quantity, fields[5], candle.volume, rounded)
+            || !common::parsing::parse_int64(fields[6], candle.close_time)) {
+            issues.rejected.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (rounded) {
+            issues.rounded.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (candle.open_time < unit.from_ms || candle.open_time >= unit.to_ms) {
+            return;
+        }
 
-                DataEvent event;
-                event.candle = candle;
-                queue_.enqueue(event);
-            } catch (const std::exception &e) {
-                std::cerr << "Error parsing line: " << line << " - " << e.what() << std::endl;
-            }
+        if (batch.type() == EventType::EMPTY) {
+            auto candles = std::make_unique<CandleBatch>();
+            candles->reserve(batch_rows_);
+            candles->symbol = unit.symbol_id;
+            candles->product_type = product_type_;
+            candles->frequency = unit.granularity == MONTHLY ? ONE_MONTH : ONE_DAY;
+            batch = DataEvent(std::move(candles));
         }
+        batch.candles().push_back(candle);
     }
 
-    void FileDownloader::deleteFile() const {
+    std::vector<DownloadUnit> plan_units(const std::vector<std::string> &symbols, const DataType data_type, const DownloadType download_type,
+        const std::string &start_date, const std::string &end_date) {
+        std::vector<ArchivePeriod> periods;
         try {
-            const auto zipPath = tmp_dir_file_ / "data.zip";
-            const auto decompressedPath = tmp_dir_file_ / "data";
-            if (std::filesystem::exists(zipPath)) {
-                std::filesystem::remove(zipPath);
-            }
-            if (std::filesystem::exists(decompressedPath)) {
-                std::filesystem::remove_all(decompressedPath);
-            }
+            periods = plan_archives(parse_date(start_date), parse_date(end_date), download_type);
         } catch (std::exception &e) {
             std::cerr << e.what() << std::endl;
+            return {};
         }
-    }
-
-    std::vector<std::string> FileDownloader::createUrls(const std::string &symbol, const std::string &start_date, const std::string &end_date) const {
-        std::vector<std::string> urls;
-        try {
-            const auto start_date_ymd = parseDateString(start_date);
-            const auto end_date_ymd = parseDateString(end_date);
-
-            auto current_date_sys = std::chrono::sys_days(start_date_ymd);
-            const auto end_date_sys = std::chrono::sys_days(end_date_ymd);
-
 
-            const std::string base_url = binance::models::getFuturesUrl(
-                symbol,
-                getDownloadTypeName(download_type_),
-                getDataTypeName(data_type_)
-            );
-
-            while (current_date_sys < end_date_sys) {
-                std::chrono::year_month_day current_ymd(current_date_sys);
-                std::string formatted_date;
-                std::string formatted_url;
-
-                if (download_type_ == MONTHLY) {
-                    formatted_date = std::format("%Y-%m", current_ymd);
-                    formatted_url = base_url + binance::models::getFileName(symbol, formatted_date, getDataTypeName(data_type_));
-
-                    auto year = current_ymd.year();
-                    auto month =  current_ymd.month();
-                    if (month == std::chrono::December) {
-                        year += std::chrono::years(1);
-                        month = std::chrono::January;
-                    } else {
-                        month += std::chrono::months(1);
-                    }
-
-                    auto next_month = year / month / std::chrono::day{1};
-                    current_date_sys = std::chrono::sys_days(next_month);
-
-                } else if (download_type_ == DAILY) {
-                    formatted_date = std::format("%Y-%m-%d", current_ymd);
-                    formatted_url = base_url + binance::models::getFileName(symbol, formatted_date, getDataTypeName(data_type_));
-                    current_date_sys += std::chrono::days(1);
-                }
-                urls.push_back(formatted_url);
+        std::vector<DownloadUnit> units;
+        units.reserve(symbols.size() * periods.size());
+        const auto data_type_name = getDataTypeName(data_type);
+        for (const std::string &symbol : symbols) {
+            for (const auto &period : periods) {
+                const std::string base_url = binance::models::getFuturesUrl(
+                    symbol,
+                    getDownloadTypeName(period.granularity),
+                    data_type_name
+                );
+                units.push_back(DownloadUnit{
+                    symbol,
+                    0,
+                    base_url + binance::models::getFileName(symbol, period.date, data_type_name),
+                    period.granularity,
+                    period.from_ms,
+                    period.to_ms
+                });
             }
-
-        } catch (std::exception &e) {
-            std::cerr << e.what() << std::endl;
-            return {};
         }
-        return urls;
+        return units;
     }
 
-    std::chrono::year_month_day FileDownloader::parseDateString(const std::string &dateString) {
-        std::stringstream ss(dateString);
-        int year, month, day;
-
-        if (char dash; !(ss >> year >> dash >> month >> dash >> day)) {
-            throw std::invalid_argument("Invalid date format. Expected YYYY-MM-DD.");
-        }
-        return std::chrono::year_month_day(
-            std::chrono::year(year),
-            std::chrono::month(month),
-            std::chrono::day(day)
-        );
+    std::vector<DownloadUnit> FileDownloader::plan(const std::vector<std::string> &symbols, const std::string &start_date, const std::string &end_date) const {
+        auto units = plan_units(symbols, data_type_, download_type_, start_date, end_date);
+        for (auto &unit : units) {
+            unit.symbol_id = reference_data_->id(unit.symbol);
+        }
+        return units;
     }
 }
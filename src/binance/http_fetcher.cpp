@@ -0,0 +1,248 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <cpr/cpr.h>
+
+#include "binancehistoricaldatafetcher/http_fetcher.h"
+#include "common/crypto/sha256.h"
+
+namespace downloader {
+
+    namespace {
+        constexpr size_t FILE_HASH_CHUNK_SIZE = 1024 * 1024;
+
+        long parse_status_line(const std::string_view header) {
+            // "HTTP/1.1 206 Partial Content" - redirects produce several, the last one wins
+            const auto space = header.find(' ');
+            if (space == std::string_view::npos) {
+                return 0;
+            }
+            long status = 0;
+            std::from_chars(header.data() + space + 1, header.data() + header.size(), status);
+            return status;
+        }
+
+        bool is_retryable_status(const long status) {
+            return status == 0 || status == 408 || status == 429 || status >= 500;
+        }
+    }
+
+    bool HttpFetcher::fetch(const std::string &url, const DataCallback &on_data, uint64_t &bytes_received) const {
+        return fetch_range(url, 0, std::nullopt, on_data, bytes_received);
+    }
+
+    std::optional<std::string> HttpFetcher::fetch_text(const std::string &url) const {
+        std::string body;
+        uint64_t bytes = 0;
+        if (!fetch(url, [&](const std::string_view data) { body.append(data); return true; }, bytes)) {
+            return std::nullopt;
+        }
+        return body;
+    }
+
+    bool HttpFetcher::fetch_to_file(const std::string &url, const std::filesystem::path &path,
+        common::crypto::Sha256 *hasher, uint64_t &bytes_received) const {
+        if (options_.range_split_bytes > 0 && options_.range_connections > 1) {
+            if (const auto length = probe_ranged_length(url); length.has_value() && *length > options_.range_split_bytes) {
+                if (!fetch_ranges_to_file(url, path, *length, bytes_received)) {
+                    return false;
+                }
+                if (hasher != nullptr) {
+                    // ranges land out of order, so hash once the file is stitched together
+                    std::ifstream file(path, std::ios::binary);
+                    std::vector<char> chunk(FILE_HASH_CHUNK_SIZE);
+                    while (file) {
+                        file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                        if (const auto n = file.gcount(); n > 0) {
+                            hasher->update(std::string_view(chunk.data(), static_cast<size_t>(n)));
+                        }
+                    }
+                }
+                return true;
+            }
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "ERROR::HttpFetcher::fetch_to_file failed to open " << path << std::endl;
+            return false;
+        }
+        const bool ok = fetch(url, [&](const std::string_view data) {
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (hasher != nullptr) {
+                hasher->update(data);
+            }
+            return file.good();
+        }, bytes_received);
+        return ok && file.good();
+    }
+
+    bool HttpFetcher::fetch_range(const std::string &url, const uint64_t offset, const std::optional<uint64_t> last_byte,
+        const DataCallback &on_data, uint64_t &bytes_received) const {
+        uint64_t delivered = 0;
+        // only attempts that make no progress count towards the limit
+        for (int failures = 1;; ++failures) {
+            const auto before = delivered;
+            const auto result = attempt(url, offset, last_byte, on_data, delivered);
+            if (result != AttemptResult::RETRY) {
+                bytes_received += delivered;
+                return result == AttemptResult::COMPLETE;
+            }
+            if (delivered > before) {
+                failures = 1;
+            }
+            if (failures >= options_.max_attempts) {
+                std::cerr << "ERROR::HttpFetcher::fetch giving up on " << url << " after " << failures << " attempts" << std::endl;
+                bytes_received += delivered;
+                return false;
+            }
+            const auto delay = backoff(failures);
+            std::cerr << "WARN::HttpFetcher::fetch retrying " << url << " from byte " << offset + delivered
+                      << " in " << delay.count() << " ms" << std::endl;
+            std::this_thread::sleep_for(delay);
+        }
+    }
+
+    HttpFetcher::AttemptResult HttpFetcher::attempt(const std::string &url, const uint64_t offset,
+        const std::optional<uint64_t> last_byte, const DataCallback &on_data, uint64_t &delivered) const {
+        const uint64_t start = offset + delivered;
+        cpr::Header headers;
+        if (start > 0 || last_byte.has_value()) {
+            headers["Range"] = "bytes=" + std::to_string(start) + "-" + (last_byte.has_value() ? std::to_string(*last_byte) : "");
+        }
+
+        long status = 0;
+        uint64_t skip = 0;
+        bool consumer_aborted = false;
+        bool range_ignored = false;
+        auto header_callback = [&](const std::string_view header, intptr_t) {
+            if (header.starts_with("HTTP/")) {
+                status = parse_status_line(header);
+                // a server that ignores Range resends the whole body; drop what the consumer already has
+                skip = status == 200 ? start : 0;
+            }
+            return true;
+        };
+        auto write_callback = [&](std::string_view data, intptr_t) {
+            if (status != 200 && status != 206) {
+                // error page body, never hand it to the consumer
+                return true;
+            }
+            if (status == 200 && last_byte.has_value()) {
+                range_ignored = true;
+                return false;
+            }
+            if (skip > 0) {
+                const auto n = static_cast<size_t>(std::min<uint64_t>(skip, data.size()));
+                data.remove_prefix(n);
+                skip -= n;
+                if (data.empty()) {
+                    return true;
+                }
+            }
+            if (!on_data(data)) {
+                consumer_aborted = true;
+                return false;
+            }
+            delivered += data.size();
+            return true;
+        };
+
+        const cpr::Response r = cpr::Get(cpr::Url{url},
+            headers,
+            cpr::LowSpeed{1, STALLED_TRANSFER_TIMEOUT},
+            cpr::HeaderCallback{header_callback},
+            cpr::WriteCallback{write_callback});
+
+        if (consumer_aborted) {
+            return AttemptResult::FAILED;
+        }
+        if (range_ignored) {
+            std::cerr << "ERROR::HttpFetcher::attempt server ignored byte range for " << url << std::endl;
+            return AttemptResult::FAILED;
+        }
+        if (!r.error && (status == 200 || status == 206)) {
+            return AttemptResult::COMPLETE;
+        }
+        if (r.error) {
+            std::cerr << "WARN::HttpFetcher::attempt " << url << ": " << r.error.message << std::endl;
+            return AttemptResult::RETRY;
+        }
+        std::cerr << "WARN::HttpFetcher::attempt " << url << ": HTTP " << status << std::endl;
+        return is_retryable_status(status) ? AttemptResult::RETRY : AttemptResult::FAILED;
+    }
+
+    bool HttpFetcher::fetch_ranges_to_file(const std::string &url, const std::filesystem::path &path,
+        const uint64_t content_length, uint64_t &bytes_received) const {
+        {
+            std::ofstream create(path, std::ios::binary | std::ios::trunc);
+        }
+        std::filesystem::resize_file(path, content_length);
+
+        const auto connections = static_cast<uint64_t>(options_.range_connections);
+        const uint64_t range_size = (content_length + connections - 1) / connections;
+        std::atomic<bool> ok{true};
+        std::atomic<uint64_t> total{0};
+        std::vector<std::thread> workers;
+        for (uint64_t first = 0; first < content_length; first += range_size) {
+            const uint64_t last = std::min(first + range_size, content_length) - 1;
+            workers.emplace_back([&, first, last] {
+                // every range writes its own slice of the pre-sized file, so no stitching pass is needed
+                std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+                file.seekp(static_cast<std::streamoff>(first));
+                uint64_t bytes = 0;
+                const bool range_ok = file.is_open() && fetch_range(url, first, last, [&](const std::string_view data) {
+                    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+                    return file.good();
+                }, bytes);
+                total.fetch_add(bytes);
+                if (!range_ok || bytes != last - first + 1) {
+                    ok.store(false);
+                }
+            });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        bytes_received += total.load();
+        return ok.load();
+    }
+
+    std::optional<uint64_t> HttpFetcher::probe_ranged_length(const std::string &url) const {
+        const cpr::Response r = cpr::Head(cpr::Url{url});
+        if (r.error || r.status_code != 200) {
+            return std::nullopt;
+        }
+        const auto accept_ranges = r.header.find("accept-ranges");
+        const auto content_length = r.header.find("content-length");
+        if (accept_ranges == r.header.end() || accept_ranges->second.find("bytes") == std::string::npos
+            || content_length == r.header.end()) {
+            return std::nullopt;
+        }
+        uint64_t length = 0;
+        const auto &value = content_length->second;
+        if (std::from_chars(value.data(), value.data() + value.size(), length).ec != std::errc{}) {
+            return std::nullopt;
+        }
+        return length;
+    }
+
+    std::chrono::milliseconds HttpFetcher::backoff(const int attempt) const {
+        // full jitter: uniform in [0, min(max, base * 2^attempt)] spreads retries from parallel workers apart
+        thread_local std::mt19937_64 rng{std::random_device{}()};
+        const auto exponent = std::min(attempt - 1, 20);
+        const auto ceiling = std::min(options_.max_backoff.count(), options_.base_backoff.count() << exponent);
+        std::uniform_int_distribution<long long> dist(0, std::max<long long>(ceiling, 1));
+        return std::chrono::milliseconds(dist(rng));
+    }
+}
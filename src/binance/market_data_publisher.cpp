@@ -50,13 +50,14 @@ namespace binance::processor {
             return;
         }
 
+        // the book builder rings events_ready for every batch it enqueues
+        common::sync::WaitStrategy wait(wait_options_, &book_builder_->events_ready());
         while (is_running_.load()) {
             if (DataEvent data_event; data_event_queue_.try_dequeue(data_event)) {
+                wait.reset();
                 try {
-                    json j = {
-                        {"sequence_id", sequence_id_.load()},
-                        {"payload", data_event}
-                    };
+                    json j = {{"sequence_id", sequence_id_.load()}};
+                    to_json(j["payload"], data_event, *reference_data_);
                     std::string j_str = j.dump();
                     updates_socket_->send(j_str.data(), j_str.size());
                     updates_socket_->send_and_receive();
@@ -66,7 +67,7 @@ namespace binance::processor {
                     std::cerr << "ERROR::MarketDataPublisher::run exception: " << e.what() << '\n';
                 }
             } else {
-                std::this_thread::yield();
+                wait.idle();
             }
         }
     }
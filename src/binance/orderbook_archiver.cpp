@@ -28,6 +28,8 @@ namespace binance::processor {
         if (is_running_.exchange(true)) {
             return; // already running
         }
+        // cleared only by stop(), the signal handler may clear is_running_ at any time
+        started_.store(true);
 
         // register signal handlers to allow Ctrl-C to stop the archiver (safe to call repeatedly)
         std::signal(SIGINT, handle_signals);
@@ -43,12 +45,23 @@ namespace binance::processor {
             if (quest_db_writer_) {
                 // run writer in its own thread; write() should block until stopped/closed
                 writer_thread_ = std::thread([this]() {
+                    // rethrowing here would terminate the process. The failure is reported through writer_failed_,
+                    // and the writer is closed so book builders blocked on its full queue are released
                     try {
                         quest_db_writer_->write();
+                    } catch (const std::exception &e) {
+                        std::cerr << "FATAL::OrderbookArchiver::start questdb writer failed: " << e.what() << std::endl;
+                        writer_failed_.store(true);
                     } catch (...) {
-                        // swallow; writer should handle its own errors
-                        std::cerr << "FATAL::OrderbookArchiver::start Error starting questdb writer" << std::endl;
-                        throw;
+                        std::cerr << "FATAL::OrderbookArchiver::start questdb writer failed" << std::endl;
+                        writer_failed_.store(true);
+                    }
+                    if (writer_failed_.load()) {
+                        try {
+                            quest_db_writer_->close();
+                        } catch (...) {
+                            std::cerr << "FATAL::OrderbookArchiver::start closing the failed questdb writer failed" << std::endl;
+                        }
                     }
                 });
             }
@@ -67,10 +80,12 @@ namespace binance::processor {
     }
 
     int OrderbookArchiver::stop() noexcept {
-        // idempotent: if already false, return
-        if (!is_running_.exchange(false)) {
+        // idempotent, and gated on started_ rather than is_running_: after a signal or a writer failure the
+        // builder threads and writer_thread_ still have to be stopped and joined
+        is_running_.store(false);
+        if (!started_.exchange(false)) {
             std::cout << "INFO::OrderbookArchiver already stopped, returning from stop()\n";
-            return EXIT_SUCCESS; // already stopped
+            return writer_failed_.load() ? EXIT_FAILURE : EXIT_SUCCESS; // already stopped
         }
 
         std::vector<int> error_codes;
@@ -102,6 +117,10 @@ namespace binance::processor {
             error_codes.emplace_back(-1);
         }
 
+        if (writer_failed_.load()) {
+            error_codes.emplace_back(-1);
+        }
+
         if (!error_codes.empty()) {
             return EXIT_FAILURE;
         }
@@ -30,6 +30,9 @@ namespace common::models::enums {
         if (downloadTypeName == "daily") {
             return DAILY;
         }
+        if (downloadTypeName == "auto") {
+            return AUTO;
+        }
         throw std::invalid_argument("Invalid download type name: " + downloadTypeName);
     }
 
@@ -39,6 +42,8 @@ namespace common::models::enums {
                 return "monthly";
             case DAILY:
                 return "daily";
+            case AUTO:
+                return "auto";
             default:
                 throw std::invalid_argument("Invalid download type enum value");
         }
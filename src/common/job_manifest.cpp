@@ -0,0 +1,151 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "common/io/job_manifest.h"
+
+namespace common::io {
+
+    namespace {
+        constexpr std::array<std::string_view, 4> STATE_NAMES = {"PLANNED", "DOWNLOADED", "PARSED", "FLUSHED"};
+
+        std::optional<UnitState> parse_unit_state(const std::string_view name) {
+            for (size_t i = 0; i < STATE_NAMES.size(); ++i) {
+                if (STATE_NAMES[i] == name) {
+                    return static_cast<UnitState>(i);
+                }
+            }
+            return std::nullopt;
+        }
+    }
+
+    std::string_view unit_state_name(const UnitState state) {
+        return STATE_NAMES[static_cast<size_t>(state)];
+    }
+
+    JobManifest::JobManifest(const std::filesystem::path &path, const bool resume, const size_t batch_size) :
+        path_(path),
+        batch_size_(std::max<size_t>(batch_size, 1)) {
+        if (path_.has_parent_path()) {
+            std::filesystem::create_directories(path_.parent_path());
+        }
+        if (resume) {
+            load();
+        }
+        const int flags = O_WRONLY | O_CREAT | O_APPEND | (resume ? 0 : O_TRUNC);
+        fd_ = ::open(path_.c_str(), flags, 0644);
+        if (fd_ < 0) {
+            throw std::runtime_error("Failed to open job manifest " + path_.string() + ": " + std::strerror(errno));
+        }
+    }
+
+    JobManifest::~JobManifest() {
+        try {
+            sync();
+        } catch (const std::exception &e) {
+            std::cerr << "ERROR::JobManifest::~JobManifest " << e.what() << std::endl;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    void JobManifest::record(const std::string &key, const UnitState state) {
+        std::lock_guard lock(mutex_);
+        auto [it, inserted] = states_.try_emplace(key, state);
+        if (!inserted) {
+            if (state <= it->second) {
+                return;
+            }
+            it->second = state;
+        }
+        pending_.push_back(std::string(unit_state_name(state)) + " " + key + "\n");
+        if (pending_.size() >= batch_size_) {
+            write_pending();
+        }
+    }
+
+    void JobManifest::sync() {
+        std::lock_guard lock(mutex_);
+        write_pending();
+    }
+
+    std::optional<UnitState> JobManifest::state(const std::string &key) const {
+        std::lock_guard lock(mutex_);
+        if (const auto it = states_.find(key); it != states_.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    bool JobManifest::is_complete(const std::string &key) const {
+        return state(key) == UnitState::FLUSHED;
+    }
+
+    void JobManifest::load() {
+        std::ifstream file(path_, std::ios::binary);
+        if (!file.is_open()) {
+            return;
+        }
+        std::string contents((std::istreambuf_iterator(file)), std::istreambuf_iterator<char>());
+        size_t line_start = 0;
+        // only newline terminated lines count, anything after the last newline is a torn write
+        for (size_t newline = contents.find('\n'); newline != std::string::npos; newline = contents.find('\n', line_start)) {
+            const std::string_view line(contents.data() + line_start, newline - line_start);
+            line_start = newline + 1;
+            const auto space = line.find(' ');
+            if (space == std::string_view::npos) {
+                continue;
+            }
+            const auto state = parse_unit_state(line.substr(0, space));
+            if (!state.has_value()) {
+                continue;
+            }
+            auto [it, inserted] = states_.try_emplace(std::string(line.substr(space + 1)), *state);
+            if (!inserted && *state > it->second) {
+                it->second = *state;
+            }
+        }
+        if (line_start < contents.size()) {
+            std::cerr << "WARN::JobManifest::load ignoring torn trailing record in " << path_ << std::endl;
+            // cut the torn record so the next append starts on a fresh line
+            std::filesystem::resize_file(path_, line_start);
+        }
+    }
+
+    void JobManifest::write_pending() {
+        if (pending_.empty()) {
+            return;
+        }
+        std::string batch;
+        for (const auto &line : pending_) {
+            batch += line;
+        }
+        size_t written = 0;
+        while (written < batch.size()) {
+            const auto n = ::write(fd_, batch.data() + written, batch.size() - written);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("Failed to write job manifest " + path_.string() + ": " + std::strerror(errno));
+            }
+            written += static_cast<size_t>(n);
+        }
+        if (::fsync(fd_) != 0) {
+            throw std::runtime_error("Failed to fsync job manifest " + path_.string() + ": " + std::strerror(errno));
+        }
+        pending_.clear();
+    }
+}
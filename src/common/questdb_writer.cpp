@@ -2,9 +2,17 @@
 // Created by jtwears on 9/14/25.
 //
 
+#include <algorithm>
+#include <charconv>
 #include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <utility>
+#include <cpr/cpr.h>
 #include <questdb/ingress/line_sender.hpp>
 
 #include "../../include/common/io/questdb_writer.h"
@@ -18,121 +26,560 @@ using namespace std::chrono_literals;
 
 namespace writer {
 
-    QuestDBWriter::QuestDBWriter(moodycamel::ConcurrentQueue<DataEvent> &buffer,
+    namespace {
+        // "http::addr=host:9000;username=...;" - values escape ';' as ';;'
+        std::vector<std::pair<std::string, std::string>> parseConf(const std::string_view params) {
+            std::vector<std::pair<std::string, std::string>> entries;
+            std::string key;
+            std::string value;
+            bool inValue = false;
+            for (size_t i = 0; i < params.size(); ++i) {
+                const char c = params[i];
+                if (!inValue) {
+                    if (c == '=') {
+                        inValue = true;
+                    } else {
+                        key += c;
+                    }
+                } else if (c == ';' && i + 1 < params.size() && params[i + 1] == ';') {
+                    value += ';';
+                    ++i;
+                } else if (c == ';') {
+                    entries.emplace_back(std::move(key), std::move(value));
+                    key.clear();
+                    value.clear();
+                    inValue = false;
+                } else {
+                    value += c;
+                }
+            }
+            if (inValue) {
+                entries.emplace_back(std::move(key), std::move(value));
+            }
+            return entries;
+        }
+
+        bool retryable(const cpr::Response &response) {
+            return response.error || response.status_code >= 500 || response.status_code == 408 || response.status_code == 429;
+        }
+
+        // meta of a spooled batch: its row count, then one acked unit per line
+        std::string encodeSpoolMeta(const size_t rows, const std::vector<std::string> &acks) {
+            std::string meta = std::to_string(rows);
+            for (const auto &unit : acks) {
+                meta += '\n';
+                meta += unit;
+            }
+            return meta;
+        }
+
+        size_t decodeSpoolMeta(const std::string_view meta, std::vector<std::string> &acks) {
+            size_t end = meta.find('\n');
+            const auto count = meta.substr(0, end);
+            size_t rows = 0;
+            std::from_chars(count.data(), count.data() + count.size(), rows);
+            while (end != std::string_view::npos) {
+                const size_t start = end + 1;
+                end = meta.find('\n', start);
+                acks.emplace_back(meta.substr(start, end == std::string_view::npos ? end : end - start));
+            }
+            return rows;
+        }
+
+        constexpr std::string_view SPOOL_CONNECTION_PREFIX = "connection-";
+
+        std::filesystem::path connectionSpoolDir(const std::filesystem::path &dir, const size_t connection) {
+            return dir / (std::string(SPOOL_CONNECTION_PREFIX) + std::to_string(connection));
+        }
+
+        // connections the spool under dir was laid out for, 1 + the highest connection-<i>; 0 for a new spool
+        size_t spooledConnections(const std::filesystem::path &dir) {
+            size_t connections = 0;
+            std::error_code ec;
+            for (const auto &entry : std::filesystem::directory_iterator(dir, ec)) {
+                const auto name = entry.path().filename().string();
+                if (!entry.is_directory() || !name.starts_with(SPOOL_CONNECTION_PREFIX)) {
+                    continue;
+                }
+                const auto digits = std::string_view(name).substr(SPOOL_CONNECTION_PREFIX.size());
+                size_t index;
+                if (const auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), index);
+                    error == std::errc{} && end == digits.data() + digits.size()) {
+                    connections = std::max(connections, index + 1);
+                }
+            }
+            return connections;
+        }
+
+        // A connection only replays its own directory, and a symbol's connection is its id modulo the
+        // connection count. Batches spooled under another count would be replayed on the wrong connection,
+        // out of order with the symbol's new rows, or never. So a spool still holding batches has to be
+        // opened with the count it was written with; an empty one is re-laid out for the new count.
+        void checkSpoolLayout(const std::filesystem::path &dir, const size_t connections, const uint64_t maxBytes) {
+            const size_t previous = spooledConnections(dir);
+            if (previous == 0 || previous == connections) {
+                return;
+            }
+            uint64_t pending = 0;
+            for (size_t i = 0; i < previous; ++i) {
+                if (const auto path = connectionSpoolDir(dir, i); std::filesystem::exists(path)) {
+                    pending += common::io::Spool(path, maxBytes).stats().records;
+                }
+            }
+            if (pending > 0) {
+                throw std::invalid_argument("The QuestDB spool at " + dir.string() + " holds " + std::to_string(pending)
+                    + " batches spooled over " + std::to_string(previous) + " connections, restart with "
+                    + std::to_string(previous) + " connections to replay them before changing the count");
+            }
+            std::cerr << "WARN::QuestDBWriter spool at " << dir.string() << " was laid out for " << previous
+                      << " connections and is empty, using " << connections << std::endl;
+            // nothing pending in them, consumed segments included
+            for (size_t i = connections; i < previous; ++i) {
+                std::filesystem::remove_all(connectionSpoolDir(dir, i));
+            }
+        }
+    }
+
+    QuestDBWriter::Connection::Connection(const std::string &uri, const size_t flushesInFlight,
+        const common::io::FlushBudget &budget, const steady_clock::duration maxLatency) :
+        sender(questdb::ingress::line_sender::from_conf(uri)),
+        current{sender.new_buffer(), 0, {}},
+        flushQueue(flushesInFlight),
+        spareBuffers(flushesInFlight),
+        tuner(budget, maxLatency) {
+        // one buffer is always being encoded, the others rotate through the flusher
+        for (size_t i = 0; i < flushesInFlight; ++i) {
+            spareBuffers.push(FlushBatch{sender.new_buffer(), 0, {}});
+        }
+    }
+
+    QuestDBWriter::QuestDBWriter(common::sync::BoundedQueue<DataEvent> &buffer,
         const std::string &dbConnectionURI,
         const std::shared_ptr<Context> &context,
-        const std::shared_ptr<std::unordered_map<std::string, ExchangeInfo>> &exchangeInfo,
-        const int batchSize,
+        const std::shared_ptr<const common::reference::ReferenceDataService> &referenceData,
+        const common::io::FlushBudget &flushBudget,
         const int flushIntervalMs,
-        const DataType dataType) : buffer_(buffer),
+        const DataType dataType,
+        const std::shared_ptr<common::io::JobManifest> &manifest,
+        const common::sync::WaitOptions &wait,
+        const size_t flushesInFlight,
+        const size_t connections,
+        const std::optional<SpoolOptions> &spool) : buffer_(buffer),
                                             dbConnectionURI(dbConnectionURI),
-                                            batchSize_(batchSize),
-                                            dbSender(questdb::ingress::line_sender::from_conf(dbConnectionURI)),
                                             flushIntervalMs_(flushIntervalMs),
                                             context_(context),
                                             dataType_(dataType),
-                                            dbBuffer_(dbSender.new_buffer()),
                                             flushInterval_(flushIntervalMs * 1ms),
-                                            exchangeInfo_(exchangeInfo)
-    {}
+                                            referenceData_(referenceData),
+                                            manifest_(manifest),
+                                            drained_(WRITER_DEQUEUE_BULK),
+                                            snapshotTensors_(dataType == SNAPSHOT ? referenceData->size() : 0),
+                                            consumerToken_(buffer.consumer_token()),
+                                            wait_(wait, &context->dataReady)
+    {
+        for (size_t i = 0; i < std::max<size_t>(connections, 1); ++i) {
+            connections_.push_back(std::make_unique<Connection>(dbConnectionURI, std::max<size_t>(flushesInFlight, 1),
+                                                                flushBudget, flushInterval_));
+        }
+        if (spool.has_value()) {
+            // spooled batches are replayed as plain ILP over HTTP, the TCP transport has no acknowledgement to wait for
+            const auto scheme_end = dbConnectionURI.find("::");
+            const auto scheme = dbConnectionURI.substr(0, scheme_end);
+            if (scheme_end == std::string::npos || (scheme != "http" && scheme != "https")) {
+                throw std::invalid_argument("The QuestDB spool needs an http or https connection string");
+            }
+            for (const auto &[key, value] : parseConf(std::string_view(dbConnectionURI).substr(scheme_end + 2))) {
+                if (key == "addr") {
+                    replayTarget_.url = scheme + "://" + value + "/write";
+                } else if (key == "username") {
+                    replayTarget_.username = value;
+                } else if (key == "password") {
+                    replayTarget_.password = value;
+                } else if (key == "token") {
+                    replayTarget_.token = value;
+                } else if (key == "tls_verify") {
+                    replayTarget_.verifyTls = value != "unsafe_off";
+                }
+            }
+            checkSpoolLayout(spool->dir, connections_.size(), spool->maxBytes);
+            for (size_t i = 0; i < connections_.size(); ++i) {
+                connections_[i]->spool = std::make_unique<common::io::Spool>(connectionSpoolDir(spool->dir, i), spool->maxBytes);
+            }
+        }
+        for (const auto &connection : connections_) {
+            connection->flusher = std::thread([this, &connection = *connection] { runFlusher(connection); });
+        }
+    }
 
+    QuestDBWriter::~QuestDBWriter() {
+        stopFlushers();
+    }
 
     void QuestDBWriter::close() {
-       if (getEventsWritten() > 0) {
-           dbSender.flush(dbBuffer_);
-       }
-        dbSender.close();
+        // producers blocked on a full queue must not wait for a writer that is gone
+        buffer_.close();
+        std::exception_ptr error;
+        try {
+            flush();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        // waits for the batches already handed over
+        stopFlushers();
+        for (const auto &connection : connections_) {
+            connection->sender.close();
+        }
         context_.get()->consumerDone.store(true);
         context_.get()->running.store(false);
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        rethrowFlushError();
     }
 
     void QuestDBWriter::write() {
         const auto now = steady_clock::now;
         while (context_.get()->running.load()) {
-            DataEvent event;
             auto start = now();
-            while (context_.get()->running.load()) {
-
-                if (!buffer_.try_dequeue(event)) {
+            // only the empty polls are timed, so the hot path costs no clock reads
+            steady_clock::duration idle{0};
+            bool due = false;
+            while (!due && context_.get()->running.load()) {
+                // whole blocks come off the queue at once, each one carries up to a batch of rows
+                const size_t count = buffer_.try_dequeue_bulk(consumerToken_, drained_.begin(), drained_.size());
+                if (count == 0) {
                    if (context_.get()->producerDone.load()) {
                        break;
                    }
-                    std::this_thread::yield();
+                    const auto idle_start = now();
+                    wait_.idle();
+                    idle += now() - idle_start;
                     continue;
                 }
+                wait_.reset();
 
-                switch (dataType_) {
-                   case TRADES:
-                       writeTradeToDbBuffer(*event.futures_trade);
-                       break;
-                    case OHLCV:
-                       writeCandleToDbBuffer(*event.candle);
-                       break;
-                    case SNAPSHOT:
-                       writeOrderbookToDbBuffer(*event.orderbook_snapshot);
-                       break;
-                    default:
-                       close();
-                       throw std::runtime_error("Unknown data type");
-               }
-                incrementEventsWritten(1);
-                if (getEventsWritten() >= batchSize_ || (steady_clock::now() - start) > flushInterval_) {
-                    break;
+                for (size_t i = 0; i < count; ++i) {
+                    // waiting for a spare buffer is time blocked on the sink, not work
+                    idle += writeEvent(drained_[i]);
+                    drained_[i] = DataEvent{};
                 }
+                due = (steady_clock::now() - start) > flushInterval_;
             }
 
-            if (getEventsWritten() > 0) {
-                dbSender.flush(dbBuffer_);
-                resetEventsWritten();
+            stats_.add_items(getEventsWritten());
+            // whatever did not reach its byte budget goes out now, bounding how long a row waits
+            idle += flush();
+            stats_.add_busy(now() - start - idle);
+            stats_.add_idle(idle);
+
+            if (context_.get()->producerDone.load() && buffer_.size_approx() == 0) {
+                close();
+                return;
             }
+        }
+    }
 
-            if (!buffer_.try_dequeue(event) && context_.get()->producerDone.load()) {
+    steady_clock::duration QuestDBWriter::writeEvent(DataEvent &event) {
+        Connection *connection;
+        switch (event.type()) {
+            case EventType::TRADE_BATCH:
+                connection = &connectionFor(event.trades().symbol);
+                writeTradesToDbBuffer(connection->current.buffer, event.trades());
+                break;
+            case EventType::CANDLE_BATCH:
+                connection = &connectionFor(event.candles().symbol);
+                writeCandlesToDbBuffer(connection->current.buffer, event.candles());
+                break;
+            case EventType::ORDERBOOK_SNAPSHOT:
+                connection = &connectionFor(event.snapshot().symbol);
+                writeOrderbookToDbBuffer(connection->current.buffer, event.snapshot());
+                break;
+            case EventType::UNIT_COMPLETE:
+                // a unit holds one symbol, so its rows went through this same connection
+                connectionFor(event.unit_complete().symbol).current.acks.push_back(std::move(event.unit_complete().key));
+                return steady_clock::duration::zero();
+            default:
                 close();
+                throw std::runtime_error("Unknown data event type");
+        }
+        connection->current.rows += event.rows();
+        incrementEventsWritten(static_cast<int>(event.rows()));
+        if (connection->current.buffer.size() < connection->tuner.target()) {
+            return steady_clock::duration::zero();
+        }
+        rethrowFlushError();
+        return flush(*connection);
+    }
+
+    steady_clock::duration QuestDBWriter::flush() {
+        rethrowFlushError();
+        steady_clock::duration waited{0};
+        for (const auto &connection : connections_) {
+            waited += flush(*connection);
+        }
+        resetEventsWritten();
+        rethrowFlushError();
+        return waited;
+    }
+
+    steady_clock::duration QuestDBWriter::flush(Connection &connection) {
+        if (connection.current.rows == 0 && connection.current.acks.empty()) {
+            return steady_clock::duration::zero();
+        }
+        const auto rows = connection.current.rows;
+        if (!connection.flushQueue.push(std::move(connection.current))) {
+            std::cerr << "ERROR::QuestDBWriter::flush flusher already stopped, dropping " << rows << " rows\n";
+            return steady_clock::duration::zero();
+        }
+        // the next batch is encoded while this one is in flight, unless flushesInFlight are outstanding
+        const auto wait_start = steady_clock::now();
+        auto spare = connection.spareBuffers.pop();
+        const auto waited = steady_clock::now() - wait_start;
+        if (!spare.has_value()) {
+            throw std::runtime_error("QuestDBWriter flusher stopped");
+        }
+        connection.current = std::move(*spare);
+        return waited;
+    }
+
+    void QuestDBWriter::runFlusher(Connection &connection) {
+        bool failed = false;
+        while (true) {
+            std::optional<FlushBatch> batch;
+            if (connection.spool && !connection.spool->empty() && !failed) {
+                // the backlog is replayed in between batches, so the queue is only waited on until the next attempt
+                batch = connection.flushQueue.pop_for(replaySpool(connection));
+            } else {
+                batch = connection.flushQueue.pop();
+            }
+            if (!batch.has_value()) {
+                if (connection.flushQueue.closed()) {
+                    break;
+                }
+                continue;
+            }
+            try {
+                if (!failed) {
+                    send(connection, *batch);
+                }
+            } catch (...) {
+                // later batches of this connection are not sent either: their units must not be acked past a gap
+                failed = true;
+                std::lock_guard lock(flushErrorMutex_);
+                flushError_ = std::current_exception();
+            }
+            batch->buffer.clear();
+            batch->rows = 0;
+            batch->acks.clear();
+            connection.spareBuffers.push(std::move(*batch));
+        }
+        if (connection.spool && !connection.spool->empty()) {
+            const auto stats = connection.spool->stats();
+            std::cerr << "WARN::QuestDBWriter::runFlusher " << stats.records << " batches (" << stats.bytes
+                      << " bytes) stay spooled, they are replayed on the next start\n";
+        }
+    }
+
+    void QuestDBWriter::send(Connection &connection, FlushBatch &batch) {
+        // behind a spooled backlog a batch has to queue up as well, or its rows would overtake older ones
+        if (!connection.spool || connection.spool->empty()) {
+            try {
+                if (const auto bytes = batch.buffer.size(); bytes > 0) {
+                    const auto flush_start = steady_clock::now();
+                    connection.sender.flush(batch.buffer);
+                    connection.tuner.observe(bytes, steady_clock::now() - flush_start);
+                    connection.rowsFlushed.fetch_add(batch.rows, std::memory_order_relaxed);
+                    connection.bytesFlushed.fetch_add(bytes, std::memory_order_relaxed);
+                }
+                ackUnits(batch.acks);
                 return;
+            } catch (const questdb::ingress::line_sender_error &e) {
+                if (!connection.spool) {
+                    throw;
+                }
+                // a failed flush leaves the buffer as it was
+                std::cerr << "WARN::QuestDBWriter::send flush failed, spooling to disk until QuestDB is back: " << e.what() << "\n";
+                connection.nextReplay = steady_clock::now() + SPOOL_REPLAY_INTERVAL;
             }
         }
+        spoolBatch(connection, batch);
+    }
+
+    void QuestDBWriter::spoolBatch(Connection &connection, const FlushBatch &batch) {
+        if (!connection.spool->append(batch.buffer.peek(), encodeSpoolMeta(batch.rows, batch.acks))) {
+            // the units stay unacked, a resumed job fetches them again
+            std::cerr << "ERROR::QuestDBWriter::spoolBatch spool is full, dropping " << batch.rows << " rows\n";
+        }
     }
 
-    void QuestDBWriter::writeCandleToDbBuffer(const Candle& candle_event) {
-        const auto openTimeAt = questdb::ingress::timestamp_micros(candle_event.open_time);
-        dbBuffer_.table("candles")
-        .symbol("symbol", candle_event.symbol)
-        .symbol("product_type", getProductName(candle_event.product_type))
-        .symbol("frequency", getCandleFrequencyName(candle_event.frequency))
-        .column("open_time", candle_event.open_time)
-        .column("open", candle_event.open)
-        .column("high", candle_event.high)
-        .column("low", candle_event.low)
-        .column("close", candle_event.close)
-        .column("volume", candle_event.volume)
-        .column("close_time", candle_event.close_time)
-        .at(openTimeAt);
-    }
-
-    void QuestDBWriter::writeTradeToDbBuffer(const Trade& trade_event) {
-        const auto tradeTimeAt = questdb::ingress::timestamp_micros(trade_event.time);
-        const auto side = sideToString(trade_event.side);
-        dbBuffer_.table("trades")
-        .symbol("symbol", trade_event.symbol)
-        .symbol("side", side)
-        .symbol("product_type", getProductName(trade_event.product_type))
-        .column("id", trade_event.id)
-        .column("price", trade_event.price)
-        .column("volume", trade_event.qty)
-        .column("quote_volume", trade_event.quote_qty)
-        .at(tradeTimeAt);
-    }
-
-    void QuestDBWriter::writeOrderbookToDbBuffer(const OrderbookSnapshot& orderbook_event) {
-        auto [tick_size, step_size] = exchangeInfo_->at(orderbook_event.symbol);
-        const auto bids = to_tensor(orderbook_event.bids, tick_size, step_size);
-        const auto asks = to_tensor(orderbook_event.asks, tick_size, step_size);
-        dbBuffer_.table("binance_snapshots")
-        .symbol("symbol", orderbook_event.symbol)
+    steady_clock::duration QuestDBWriter::replaySpool(Connection &connection) {
+        const auto now = steady_clock::now();
+        if (now < connection.nextReplay) {
+            return connection.nextReplay - now;
+        }
+        std::vector<std::string> acks;
+        for (size_t i = 0; i < SPOOL_REPLAY_BATCH; ++i) {
+            const auto record = connection.spool->front();
+            if (!record.has_value()) {
+                break;
+            }
+            bool delivered = true;
+            if (!record->payload.empty()) {
+                cpr::Session session;
+                session.SetUrl(cpr::Url{replayTarget_.url});
+                session.SetBody(cpr::Body{std::string(record->payload)});
+                cpr::Header headers{{"Content-Type", "text/plain; charset=utf-8"}};
+                if (!replayTarget_.token.empty()) {
+                    headers.emplace("Authorization", "Bearer " + replayTarget_.token);
+                }
+                session.SetHeader(headers);
+                if (!replayTarget_.username.empty()) {
+                    session.SetAuth(cpr::Authentication{replayTarget_.username, replayTarget_.password, cpr::AuthMode::BASIC});
+                }
+                session.SetVerifySsl(cpr::VerifySsl{replayTarget_.verifyTls});
+                session.SetTimeout(cpr::Timeout{SPOOL_REPLAY_TIMEOUT});
+                const auto response = session.Post();
+                if (retryable(response)) {
+                    connection.nextReplay = steady_clock::now() + SPOOL_REPLAY_INTERVAL;
+                    return SPOOL_REPLAY_INTERVAL;
+                }
+                if (response.status_code >= 400) {
+                    // rejected rows would be rejected forever, skipping them keeps the rest of the spool moving.
+                    // Their units stay unacked.
+                    std::cerr << "ERROR::QuestDBWriter::replaySpool QuestDB rejected a spooled batch of " << record->payload.size()
+                              << " bytes, dropping it: " << response.status_code << " " << response.text << "\n";
+                    delivered = false;
+                }
+            }
+            if (delivered) {
+                acks.clear();
+                const auto rows = decodeSpoolMeta(record->meta, acks);
+                connection.rowsFlushed.fetch_add(rows, std::memory_order_relaxed);
+                connection.bytesFlushed.fetch_add(record->payload.size(), std::memory_order_relaxed);
+                ackUnits(acks);
+            }
+            connection.spool->pop();
+            if (connection.spool->empty()) {
+                std::cout << "INFO::QuestDBWriter::replaySpool spool drained, flushing directly again" << std::endl;
+                break;
+            }
+        }
+        return steady_clock::duration::zero();
+    }
+
+    void QuestDBWriter::ackUnits(const std::vector<std::string> &units) {
+        // every row ahead of these markers is now in QuestDB, so a resumed job can skip the units
+        if (!manifest_ || units.empty()) {
+            return;
+        }
+        for (const auto &unit : units) {
+            manifest_->record(unit, common::io::UnitState::FLUSHED);
+        }
+        manifest_->sync();
+    }
+
+    void QuestDBWriter::stopFlushers() {
+        for (const auto &connection : connections_) {
+            connection->flushQueue.close();
+        }
+        for (const auto &connection : connections_) {
+            if (connection->flusher.joinable() && connection->flusher.get_id() != std::this_thread::get_id()) {
+                connection->flusher.join();
+            }
+            connection->spareBuffers.close();
+        }
+    }
+
+    std::vector<ConnectionStats> QuestDBWriter::connectionStats() const {
+        std::vector<ConnectionStats> stats;
+        stats.reserve(connections_.size());
+        for (const auto &connection : connections_) {
+            stats.push_back({
+                connection->rowsFlushed.load(std::memory_order_relaxed),
+                connection->bytesFlushed.load(std::memory_order_relaxed),
+                connection->tuner.target(),
+                connection->spool ? connection->spool->stats() : common::io::SpoolStats{}
+            });
+        }
+        return stats;
+    }
+
+    void QuestDBWriter::rethrowFlushError() {
+        std::lock_guard lock(flushErrorMutex_);
+        if (flushError_) {
+            std::rethrow_exception(std::exchange(flushError_, nullptr));
+        }
+    }
+
+    void QuestDBWriter::writeCandlesToDbBuffer(questdb::ingress::line_sender_buffer &buffer, const CandleBatch& candles) {
+        const auto productType = getProductName(candles.product_type);
+        const auto frequency = getCandleFrequencyName(candles.frequency);
+        const auto &symbol = referenceData_->name(candles.symbol);
+        // the mantissas become doubles only here, QuestDB stores DOUBLE columns
+        const auto &price = referenceData_->archive_price_codec(candles.symbol);
+        const auto &quantity = referenceData_->archive_quantity_codec(candles.symbol);
+        for (size_t i = 0; i < candles.size(); ++i) {
+            buffer.table("candles")
+            .symbol("symbol", symbol)
+            .symbol("product_type", productType)
+            .symbol("frequency", frequency)
+            .column("open_time", candles.open_time[i])
+            .column("open", price.to_double(candles.open[i]))
+            .column("high", price.to_double(candles.high[i]))
+            .column("low", price.to_double(candles.low[i]))
+            .column("close", price.to_double(candles.close[i]))
+            .column("volume", quantity.to_double(candles.volume[i]))
+            .column("close_time", candles.close_time[i])
+            .at(questdb::ingress::timestamp_micros(candles.open_time[i]));
+        }
+    }
+
+    void QuestDBWriter::writeTradesToDbBuffer(questdb::ingress::line_sender_buffer &buffer, const TradeBatch& trades) {
+        const auto productType = getProductName(trades.product_type);
+        const auto &symbol = referenceData_->name(trades.symbol);
+        const auto &price = referenceData_->archive_price_codec(trades.symbol);
+        const auto &quantity = referenceData_->archive_quantity_codec(trades.symbol);
+        const auto &notional = referenceData_->notional_codec(trades.symbol);
+        for (size_t i = 0; i < trades.size(); ++i) {
+            buffer.table("trades")
+            .symbol("symbol", symbol)
+            .symbol("side", sideToString(trades.side[i]))
+            .symbol("product_type", productType)
+            .column("id", trades.id[i])
+            .column("price", price.to_double(trades.price[i]))
+            .column("volume", quantity.to_double(trades.qty[i]))
+            .column("quote_volume", notional.to_double(trades.quote_qty[i]))
+            .at(questdb::ingress::timestamp_micros(trades.time[i]));
+        }
+    }
+
+    void QuestDBWriter::writeOrderbookToDbBuffer(questdb::ingress::line_sender_buffer &buffer, const OrderbookSnapshot& orderbook_event) {
+        const auto &price = referenceData_->price_codec(orderbook_event.symbol);
+        const auto &quantity = referenceData_->quantity_codec(orderbook_event.symbol);
+        if (orderbook_event.symbol >= snapshotTensors_.size()) {
+            snapshotTensors_.resize(orderbook_event.symbol + 1);
+        }
+        auto &[bids, asks] = snapshotTensors_[orderbook_event.symbol];
+        to_tensor(orderbook_event.bids, price, quantity, bids);
+        to_tensor(orderbook_event.asks, price, quantity, asks);
+        buffer.table("binance_snapshots")
+        .symbol("symbol", referenceData_->name(orderbook_event.symbol))
         .symbol("product_type", getProductName(orderbook_event.product_type))
         .column("bids", bids)
-        .column("asks", asks)
-        .at_now();
+        .column("asks", asks);
+        // exact fixed point sums, so a side's notional compares with trades' quote_volume to the last digit
+        const auto &notional = referenceData_->notional_codec(orderbook_event.symbol);
+        const auto bid_vwap = common::io::depth_vwap(orderbook_event.bids.data(), orderbook_event.bids.size(), price.precision, quantity.precision);
+        const auto ask_vwap = common::io::depth_vwap(orderbook_event.asks.data(), orderbook_event.asks.size(), price.precision, quantity.precision);
+        if (bid_vwap.has_value()) {
+            buffer.column("bid_notional", notional.to_double(bid_vwap->notional))
+            .column("bid_vwap", price.to_double(bid_vwap->vwap));
+        }
+        if (ask_vwap.has_value()) {
+            buffer.column("ask_notional", notional.to_double(ask_vwap->notional))
+            .column("ask_vwap", price.to_double(ask_vwap->vwap));
+        }
+        buffer.at_now();
 
     }
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <limits>
+#include <cpr/cpr.h>
+
+#include "common/reference/reference_data_service.h"
+
+namespace common::reference {
+
+    namespace {
+
+        std::string upper(const std::string_view name) {
+            std::string key(name);
+            std::ranges::transform(key, key.begin(), [](const unsigned char c) { return static_cast<char>(std::toupper(c)); });
+            return key;
+        }
+
+        // "0.00100000" -> 3, "1.00000000" -> 0
+        int decimals(const std::string &increment) {
+            const auto dot = increment.find('.');
+            if (dot == std::string::npos) {
+                return 0;
+            }
+            const auto last = increment.find_last_not_of('0');
+            return last == std::string::npos || last <= dot ? 0 : static_cast<int>(last - dot);
+        }
+
+        int filter_decimals(const nlohmann::json &symbol, const std::string_view filter_type, const char *field) {
+            for (const auto &filter : symbol.value("filters", nlohmann::json::array())) {
+                if (filter.value("filterType", "") == filter_type) {
+                    return decimals(filter.at(field).get<std::string>());
+                }
+            }
+            throw std::runtime_error("No " + std::string(filter_type) + " filter for " + symbol.at("symbol").get<std::string>());
+        }
+
+        std::pair<TickSize, StepSize> scales(const nlohmann::json &symbol) {
+            const auto tick_size = symbol.contains("pricePrecision")
+                ? symbol.at("pricePrecision").get<int>()
+                : filter_decimals(symbol, "PRICE_FILTER", "tickSize");
+            const auto step_size = symbol.contains("quantityPrecision")
+                ? symbol.at("quantityPrecision").get<int>()
+                : filter_decimals(symbol, "LOT_SIZE", "stepSize");
+            if (tick_size < 0 || step_size < 0
+                || static_cast<size_t>(tick_size) > rounding::MAX_PRECISION
+                || static_cast<size_t>(step_size) > rounding::MAX_PRECISION) {
+                throw std::runtime_error("Unsupported precision for " + symbol.at("symbol").get<std::string>());
+            }
+            return {tick_size, step_size};
+        }
+    }
+
+    ReferenceDataService ReferenceDataService::from_exchange_info(const nlohmann::json &exchange_info, const std::vector<std::string> &symbols) {
+        ReferenceDataService reference;
+        const auto &entries = exchange_info.at("symbols");
+        if (symbols.empty()) {
+            for (const auto &entry : entries) {
+                const auto [tick_size, step_size] = scales(entry);
+                reference.add(entry.at("symbol").get<std::string>(), tick_size, step_size);
+            }
+            return reference;
+        }
+
+        std::unordered_map<std::string, const nlohmann::json *> by_name;
+        for (const auto &entry : entries) {
+            by_name.emplace(upper(entry.at("symbol").get<std::string>()), &entry);
+        }
+        for (const auto &symbol : symbols) {
+            const auto it = by_name.find(upper(symbol));
+            if (it == by_name.end()) {
+                throw std::runtime_error("Symbol not found in reference data: " + symbol);
+            }
+            const auto [tick_size, step_size] = scales(*it->second);
+            reference.add(symbol, tick_size, step_size);
+        }
+        return reference;
+    }
+
+    ReferenceDataService ReferenceDataService::from_file(const std::filesystem::path &path, const std::vector<std::string> &symbols) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open reference data file: " + path.string());
+        }
+        return from_exchange_info(nlohmann::json::parse(file), symbols);
+    }
+
+    ReferenceDataService ReferenceDataService::from_url(const std::string &url, const std::vector<std::string> &symbols) {
+        const auto response = cpr::Get(cpr::Url{url});
+        if (response.status_code != 200) {
+            throw std::runtime_error("Failed to fetch reference data from " + url + ": HTTP " + std::to_string(response.status_code));
+        }
+        return from_exchange_info(nlohmann::json::parse(response.text), symbols);
+    }
+
+    Symbol ReferenceDataService::add(const std::string_view name, const TickSize tick_size, const StepSize step_size) {
+        auto key = upper(name);
+        if (const auto it = ids_.find(key); it != ids_.end()) {
+            return it->second;
+        }
+        if (names_.size() > std::numeric_limits<Symbol>::max()) {
+            throw std::length_error("Too many symbols for the Symbol id type");
+        }
+        const Codecs codecs{
+            &rounding::decimal_codec<models::types::Price>(tick_size),
+            &rounding::decimal_codec<models::types::Quantity>(step_size),
+            &rounding::decimal_codec<models::types::Price>(std::max(tick_size, ARCHIVE_PRECISION)),
+            &rounding::decimal_codec<models::types::Quantity>(std::max(step_size, ARCHIVE_PRECISION)),
+            &rounding::decimal_codec<models::types::Price>(std::max(tick_size + step_size, ARCHIVE_PRECISION)),
+        };
+        const auto symbol = static_cast<Symbol>(names_.size());
+        codecs_.push_back(codecs);
+        names_.emplace_back(name);
+        tick_sizes_.push_back(tick_size);
+        step_sizes_.push_back(step_size);
+        ids_.emplace(std::move(key), symbol);
+        return symbol;
+    }
+
+    std::optional<Symbol> ReferenceDataService::find(const std::string_view name) const {
+        // symbol names fit the small string buffer, so this does not allocate
+        if (const auto it = ids_.find(upper(name)); it != ids_.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,65 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <openssl/evp.h>
+
+#include "common/crypto/sha256.h"
+
+namespace common::crypto {
+
+    namespace {
+        constexpr size_t HASH_READ_CHUNK_SIZE = 1024 * 1024;
+    }
+
+    Sha256::Sha256() : ctx_(EVP_MD_CTX_new()) {
+        if (ctx_ == nullptr || EVP_DigestInit_ex(ctx_, EVP_sha256(), nullptr) != 1) {
+            EVP_MD_CTX_free(ctx_);
+            throw std::runtime_error("Failed to initialise SHA-256 context");
+        }
+    }
+
+    Sha256::~Sha256() {
+        EVP_MD_CTX_free(ctx_);
+    }
+
+    void Sha256::update(const std::string_view data) {
+        EVP_DigestUpdate(ctx_, data.data(), data.size());
+    }
+
+    std::string Sha256::hex_digest() {
+        std::array<unsigned char, EVP_MAX_MD_SIZE> digest{};
+        unsigned int length = 0;
+        EVP_DigestFinal_ex(ctx_, digest.data(), &length);
+        EVP_DigestInit_ex(ctx_, EVP_sha256(), nullptr);
+
+        constexpr auto hex = "0123456789abcdef";
+        std::string out;
+        out.reserve(length * 2);
+        for (unsigned int i = 0; i < length; ++i) {
+            out.push_back(hex[digest[i] >> 4]);
+            out.push_back(hex[digest[i] & 0x0f]);
+        }
+        return out;
+    }
+
+    std::string Sha256::hash_file(const std::filesystem::path &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open " + path.string() + " for hashing");
+        }
+        Sha256 hasher;
+        std::vector<char> chunk(HASH_READ_CHUNK_SIZE);
+        while (file) {
+            file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            if (const auto n = file.gcount(); n > 0) {
+                hasher.update(std::string_view(chunk.data(), static_cast<size_t>(n)));
+            }
+        }
+        return hasher.hex_digest();
+    }
+}
@@ -0,0 +1,279 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "common/io/spool.h"
+
+namespace common::io {
+
+    namespace {
+        constexpr uint32_t RECORD_MAGIC = 0x4C4F4F50; // "POOL"
+        constexpr uint32_t RECORD_PENDING = 0;
+        constexpr uint32_t RECORD_CONSUMED = 1;
+        constexpr std::string_view SEGMENT_PREFIX = "segment-";
+        constexpr std::string_view SEGMENT_SUFFIX = ".spool";
+
+        // the segment files are zero filled, a zero magic is the end of the written records
+        struct RecordHeader {
+            uint32_t magic;
+            uint32_t state;
+            uint32_t payloadSize;
+            uint32_t metaSize;
+            uint32_t crc; // over the sizes and the body, not the state that pop() flips
+            uint32_t reserved;
+        };
+        static_assert(sizeof(RecordHeader) == 24);
+
+        constexpr size_t MAX_RECORD_BODY = std::numeric_limits<uint32_t>::max() - sizeof(RecordHeader);
+
+        // records stay 8 byte aligned so the headers can be accessed in place
+        size_t recordSize(const size_t payload, const size_t meta) {
+            return (sizeof(RecordHeader) + payload + meta + 7) & ~size_t{7};
+        }
+
+        RecordHeader *headerAt(std::byte *data, const size_t offset) {
+            return reinterpret_cast<RecordHeader *>(data + offset);
+        }
+
+        uint32_t checksum(const RecordHeader &header, const std::byte *body) {
+            uLong crc = crc32(0L, Z_NULL, 0);
+            const uint32_t sizes[2] = {header.payloadSize, header.metaSize};
+            crc = crc32(crc, reinterpret_cast<const Bytef *>(sizes), sizeof(sizes));
+            crc = crc32(crc, reinterpret_cast<const Bytef *>(body), header.payloadSize + header.metaSize);
+            return static_cast<uint32_t>(crc);
+        }
+    }
+
+    Spool::Spool(const std::filesystem::path &dir, const uint64_t maxBytes, const size_t segmentBytes) :
+        dir_(dir),
+        maxBytes_(maxBytes),
+        segmentBytes_(std::max(segmentBytes, recordSize(0, 0))) {
+        std::filesystem::create_directories(dir_);
+        recover();
+    }
+
+    Spool::~Spool() {
+        for (const auto &segment : segments_) {
+            ::msync(segment.data, segment.size, MS_SYNC);
+            ::munmap(segment.data, segment.size);
+            ::close(segment.fd);
+        }
+    }
+
+    bool Spool::append(const std::string_view payload, const std::string_view meta) {
+        if (payload.size() + meta.size() > MAX_RECORD_BODY) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        const size_t size = recordSize(payload.size(), meta.size());
+        if (segments_.empty() || segments_.back().sealed || segments_.back().size - segments_.back().writeOffset < size) {
+            const size_t segmentSize = std::max(segmentBytes_, size);
+            if (diskBytes_.load(std::memory_order_relaxed) + segmentSize > maxBytes_) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (!segments_.empty()) {
+                segments_.back().sealed = true;
+            }
+            openSegment(nextSequence_++, segmentSize, true);
+        }
+        auto &segment = segments_.back();
+        auto *header = headerAt(segment.data, segment.writeOffset);
+        auto *body = reinterpret_cast<std::byte *>(header + 1);
+        if (!payload.empty()) {
+            std::memcpy(body, payload.data(), payload.size());
+        }
+        if (!meta.empty()) {
+            std::memcpy(body + payload.size(), meta.data(), meta.size());
+        }
+        header->state = RECORD_PENDING;
+        header->payloadSize = static_cast<uint32_t>(payload.size());
+        header->metaSize = static_cast<uint32_t>(meta.size());
+        header->reserved = 0;
+        header->crc = checksum(*header, body);
+        // the magic goes last, a record is not there for recover() before it is complete
+        std::atomic_ref(header->magic).store(RECORD_MAGIC, std::memory_order_release);
+        segment.writeOffset += size;
+
+        records_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(payload.size(), std::memory_order_relaxed);
+        spooled_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    std::optional<SpoolRecord> Spool::front() {
+        while (!segments_.empty()) {
+            auto &segment = segments_.front();
+            while (segment.readOffset < segment.writeOffset) {
+                const auto *header = headerAt(segment.data, segment.readOffset);
+                if (header->state == RECORD_PENDING) {
+                    const auto *body = reinterpret_cast<const char *>(header + 1);
+                    return SpoolRecord{
+                        {body, header->payloadSize},
+                        {body + header->payloadSize, header->metaSize}
+                    };
+                }
+                // consumed before a restart
+                segment.readOffset += recordSize(header->payloadSize, header->metaSize);
+            }
+            if (!segment.sealed) {
+                // appends continue in this one
+                return std::nullopt;
+            }
+            removeFront();
+        }
+        return std::nullopt;
+    }
+
+    void Spool::pop() {
+        if (!front().has_value()) {
+            return;
+        }
+        auto &segment = segments_.front();
+        auto *header = headerAt(segment.data, segment.readOffset);
+        std::atomic_ref(header->state).store(RECORD_CONSUMED, std::memory_order_relaxed);
+        segment.readOffset += recordSize(header->payloadSize, header->metaSize);
+
+        records_.fetch_sub(1, std::memory_order_relaxed);
+        bytes_.fetch_sub(header->payloadSize, std::memory_order_relaxed);
+        replayed_.fetch_add(1, std::memory_order_relaxed);
+        if (segment.sealed && segment.readOffset >= segment.writeOffset) {
+            removeFront();
+        }
+    }
+
+    SpoolStats Spool::stats() const noexcept {
+        return {
+            records_.load(std::memory_order_relaxed),
+            bytes_.load(std::memory_order_relaxed),
+            diskBytes_.load(std::memory_order_relaxed),
+            spooled_.load(std::memory_order_relaxed),
+            replayed_.load(std::memory_order_relaxed),
+            dropped_.load(std::memory_order_relaxed),
+        };
+    }
+
+    void Spool::recover() {
+        std::vector<uint64_t> sequences;
+        for (const auto &entry : std::filesystem::directory_iterator(dir_)) {
+            const auto name = entry.path().filename().string();
+            if (!entry.is_regular_file() || !name.starts_with(SEGMENT_PREFIX) || !name.ends_with(SEGMENT_SUFFIX)) {
+                continue;
+            }
+            const auto digits = std::string_view(name).substr(SEGMENT_PREFIX.size(), name.size() - SEGMENT_PREFIX.size() - SEGMENT_SUFFIX.size());
+            uint64_t sequence;
+            if (const auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), sequence);
+                ec != std::errc{} || end != digits.data() + digits.size()) {
+                continue;
+            }
+            sequences.push_back(sequence);
+        }
+        std::ranges::sort(sequences);
+
+        for (const auto sequence : sequences) {
+            nextSequence_ = sequence + 1;
+            const auto size = std::filesystem::file_size(segmentPath(sequence));
+            if (size < sizeof(RecordHeader)) {
+                std::filesystem::remove(segmentPath(sequence));
+                continue;
+            }
+            auto &segment = openSegment(sequence, size, false);
+            segment.sealed = true;
+            std::optional<size_t> firstPending;
+            uint64_t pending = 0;
+            uint64_t pendingBytes = 0;
+            size_t offset = 0;
+            while (offset + sizeof(RecordHeader) <= segment.size) {
+                const auto *header = headerAt(segment.data, offset);
+                if (header->magic != RECORD_MAGIC) {
+                    break;
+                }
+                const size_t next = offset + recordSize(header->payloadSize, header->metaSize);
+                if (next > segment.size || checksum(*header, reinterpret_cast<const std::byte *>(header + 1)) != header->crc) {
+                    std::cerr << "WARN::Spool::recover torn record in " << segmentPath(sequence).string()
+                              << " at offset " << offset << ", the rest of the segment is skipped\n";
+                    break;
+                }
+                if (header->state == RECORD_PENDING) {
+                    firstPending = firstPending.value_or(offset);
+                    ++pending;
+                    pendingBytes += header->payloadSize;
+                }
+                offset = next;
+            }
+            if (pending == 0) {
+                ::munmap(segment.data, segment.size);
+                ::close(segment.fd);
+                diskBytes_.fetch_sub(segment.size, std::memory_order_relaxed);
+                std::filesystem::remove(segmentPath(sequence));
+                segments_.pop_back();
+                continue;
+            }
+            segment.writeOffset = offset;
+            segment.readOffset = firstPending.value();
+            records_.fetch_add(pending, std::memory_order_relaxed);
+            bytes_.fetch_add(pendingBytes, std::memory_order_relaxed);
+        }
+        if (!empty()) {
+            std::cout << "INFO::Spool::recover " << records_.load() << " records (" << bytes_.load() << " bytes) to replay from "
+                      << dir_.string() << std::endl;
+        }
+    }
+
+    Spool::Segment &Spool::openSegment(const uint64_t sequence, const size_t size, const bool create) {
+        const auto path = segmentPath(sequence);
+        const int fd = ::open(path.c_str(), O_RDWR | (create ? O_CREAT | O_EXCL : 0), 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open spool segment " + path.string() + ": " + std::strerror(errno));
+        }
+        // allocated up front: a full disk must fail here, not as a SIGBUS on a write through the mapping
+        if (create) {
+            if (const int error = ::posix_fallocate(fd, 0, static_cast<off_t>(size)); error != 0) {
+                ::close(fd);
+                std::filesystem::remove(path);
+                throw std::runtime_error("Failed to allocate spool segment " + path.string() + ": " + std::strerror(error));
+            }
+        }
+        void *data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            const int error = errno;
+            ::close(fd);
+            throw std::runtime_error("Failed to map spool segment " + path.string() + ": " + std::strerror(error));
+        }
+        diskBytes_.fetch_add(size, std::memory_order_relaxed);
+        segments_.push_back(Segment{sequence, fd, static_cast<std::byte *>(data), size, 0, 0, false});
+        return segments_.back();
+    }
+
+    void Spool::removeFront() {
+        const auto &segment = segments_.front();
+        ::munmap(segment.data, segment.size);
+        ::close(segment.fd);
+        diskBytes_.fetch_sub(segment.size, std::memory_order_relaxed);
+        std::error_code ec;
+        std::filesystem::remove(segmentPath(segment.sequence), ec);
+        segments_.pop_front();
+    }
+
+    std::filesystem::path Spool::segmentPath(const uint64_t sequence) const {
+        auto digits = std::to_string(sequence);
+        digits.insert(0, 20 - std::min<size_t>(digits.size(), 20), '0');
+        return dir_ / (std::string(SEGMENT_PREFIX) + digits + std::string(SEGMENT_SUFFIX));
+    }
+}
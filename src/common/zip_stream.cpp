@@ -0,0 +1,186 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+#include "common/io/zip_stream.h"
+
+namespace common::io {
+
+    namespace {
+        constexpr uint32_t LOCAL_FILE_HEADER_SIGNATURE = 0x04034b50;
+        constexpr uint32_t DATA_DESCRIPTOR_SIGNATURE = 0x08074b50;
+        constexpr size_t LOCAL_FILE_HEADER_SIZE = 30;
+        constexpr uint16_t FLAG_DATA_DESCRIPTOR = 0x0008;
+        constexpr uint16_t METHOD_STORED = 0;
+        constexpr uint16_t METHOD_DEFLATE = 8;
+
+        uint16_t read_u16(const char *p) {
+            return static_cast<uint16_t>(static_cast<uint8_t>(p[0]) | static_cast<uint8_t>(p[1]) << 8);
+        }
+
+        uint32_t read_u32(const char *p) {
+            return static_cast<uint32_t>(read_u16(p)) | static_cast<uint32_t>(read_u16(p + 2)) << 16;
+        }
+    }
+
+    ZipInflateStream::ZipInflateStream(Sink sink, const size_t chunk_size) :
+        sink_(std::move(sink)),
+        out_(chunk_size) {}
+
+    ZipInflateStream::~ZipInflateStream() {
+        if (zs_initialised_) {
+            inflateEnd(&zs_);
+        }
+    }
+
+    bool ZipInflateStream::feed(std::string_view bytes) {
+        bytes_in_ += bytes.size();
+        while (!bytes.empty()) {
+            switch (state_) {
+                case State::HEADER:
+                    if (!parse_header(bytes)) {
+                        return state_ != State::ERROR;
+                    }
+                    break;
+                case State::DATA:
+                    if (!(method_ == METHOD_DEFLATE ? inflate_data(bytes) : copy_stored(bytes))) {
+                        return false;
+                    }
+                    break;
+                case State::TRAILER: {
+                    // data descriptor: optional signature, crc, compressed size, uncompressed size
+                    const auto take = std::min(bytes.size(), 16 - trailer_.size());
+                    trailer_.append(bytes.substr(0, take));
+                    bytes.remove_prefix(take);
+                    if (trailer_.size() == 16) {
+                        state_ = State::DONE;
+                    }
+                    break;
+                }
+                case State::DONE:
+                    // central directory and any further entries are not needed
+                    return true;
+                case State::ERROR:
+                    return false;
+            }
+        }
+        return state_ != State::ERROR;
+    }
+
+    bool ZipInflateStream::finish() {
+        if (state_ == State::TRAILER && trailer_.size() >= 4) {
+            state_ = State::DONE;
+        }
+        if (state_ != State::DONE) {
+            return state_ == State::ERROR ? false : fail("truncated zip stream");
+        }
+        if (flags_ & FLAG_DATA_DESCRIPTOR) {
+            const bool has_signature = read_u32(trailer_.data()) == DATA_DESCRIPTOR_SIGNATURE;
+            const size_t offset = has_signature ? 4 : 0;
+            if (trailer_.size() < offset + 4) {
+                return fail("truncated data descriptor");
+            }
+            expected_crc_ = read_u32(trailer_.data() + offset);
+        }
+        if (crc_ != expected_crc_) {
+            return fail("crc mismatch");
+        }
+        return true;
+    }
+
+    bool ZipInflateStream::parse_header(std::string_view &bytes) {
+        // accumulate the fixed header first, then the variable length name and extra fields
+        if (header_.size() < LOCAL_FILE_HEADER_SIZE) {
+            const auto take = std::min(bytes.size(), LOCAL_FILE_HEADER_SIZE - header_.size());
+            header_.append(bytes.substr(0, take));
+            bytes.remove_prefix(take);
+            if (header_.size() < LOCAL_FILE_HEADER_SIZE) {
+                return false;
+            }
+            if (read_u32(header_.data()) != LOCAL_FILE_HEADER_SIGNATURE) {
+                return fail("missing local file header signature");
+            }
+        }
+
+        const size_t total = LOCAL_FILE_HEADER_SIZE + read_u16(header_.data() + 26) + read_u16(header_.data() + 28);
+        const auto take = std::min(bytes.size(), total - header_.size());
+        header_.append(bytes.substr(0, take));
+        bytes.remove_prefix(take);
+        if (header_.size() < total) {
+            return false;
+        }
+
+        flags_ = read_u16(header_.data() + 6);
+        method_ = read_u16(header_.data() + 8);
+        expected_crc_ = read_u32(header_.data() + 14);
+        stored_remaining_ = read_u32(header_.data() + 18);
+
+        if (method_ == METHOD_DEFLATE) {
+            if (inflateInit2(&zs_, -MAX_WBITS) != Z_OK) {
+                return fail("inflateInit2 failed");
+            }
+            zs_initialised_ = true;
+        } else if (method_ == METHOD_STORED) {
+            if (flags_ & FLAG_DATA_DESCRIPTOR) {
+                return fail("stored entry without sizes cannot be streamed");
+            }
+        } else {
+            return fail("unsupported compression method " + std::to_string(method_));
+        }
+        state_ = State::DATA;
+        return true;
+    }
+
+    bool ZipInflateStream::inflate_data(std::string_view &bytes) {
+        zs_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(bytes.data()));
+        zs_.avail_in = static_cast<uInt>(bytes.size());
+        while (zs_.avail_in > 0) {
+            zs_.next_out = reinterpret_cast<Bytef *>(out_.data());
+            zs_.avail_out = static_cast<uInt>(out_.size());
+            const int res = inflate(&zs_, Z_NO_FLUSH);
+            if (res != Z_OK && res != Z_STREAM_END && res != Z_BUF_ERROR) {
+                return fail(zs_.msg != nullptr ? zs_.msg : "inflate failed");
+            }
+            emit(out_.data(), out_.size() - zs_.avail_out);
+            if (res == Z_STREAM_END) {
+                state_ = (flags_ & FLAG_DATA_DESCRIPTOR) ? State::TRAILER : State::DONE;
+                break;
+            }
+            if (res == Z_BUF_ERROR) {
+                break;
+            }
+        }
+        bytes.remove_prefix(bytes.size() - zs_.avail_in);
+        return true;
+    }
+
+    bool ZipInflateStream::copy_stored(std::string_view &bytes) {
+        const auto take = static_cast<size_t>(std::min<uint64_t>(bytes.size(), stored_remaining_));
+        emit(bytes.data(), take);
+        bytes.remove_prefix(take);
+        stored_remaining_ -= take;
+        if (stored_remaining_ == 0) {
+            state_ = State::DONE;
+        }
+        return true;
+    }
+
+    void ZipInflateStream::emit(const char *data, const size_t len) {
+        if (len == 0) {
+            return;
+        }
+        crc_ = crc32(crc_, reinterpret_cast<const Bytef *>(data), static_cast<uInt>(len));
+        bytes_out_ += len;
+        sink_(std::string_view(data, len));
+    }
+
+    bool ZipInflateStream::fail(std::string message) {
+        state_ = State::ERROR;
+        error_ = std::move(message);
+        return false;
+    }
+}
@@ -0,0 +1,138 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// ArchiveCache: hit, miss, checksum mismatch and LRU eviction, including the pins that keep an object
+// handed out by lookup / commit on disk until it is released.
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "binancehistoricaldatafetcher/archive_cache.h"
+#include "check.h"
+
+namespace {
+
+    using downloader::ArchiveCache;
+
+    const std::string BASE_URL = "https://data.binance.vision/data/futures/um/monthly/trades/BTCUSDT/";
+
+    // a fresh cache root per case
+    std::filesystem::path cache_root(const std::string &name) {
+        const auto root = std::filesystem::temp_directory_path() / ("archive_cache_test_" + name);
+        std::filesystem::remove_all(root);
+        return root;
+    }
+
+    // 64 hex digits, distinct per seed; the cache trusts the digests it is given
+    std::string digest(const char seed) {
+        return std::string(63, 'a') + seed;
+    }
+
+    std::filesystem::path stage(const ArchiveCache &cache, const std::string &url, const size_t bytes) {
+        const auto staged = cache.staging_path(url);
+        std::ofstream out(staged, std::ios::binary);
+        out << std::string(bytes, 'x');
+        return staged;
+    }
+
+    // commits bytes under url with a matching digest, last used an hour ago plus newer_by_seconds
+    std::filesystem::path commit(ArchiveCache &cache, const std::string &url, const char seed, const size_t bytes,
+                                 const int newer_by_seconds) {
+        const auto object = cache.commit(url, stage(cache, url, bytes), digest(seed), digest(seed));
+        CHECK(object.has_value());
+        if (object.has_value()) {
+            std::filesystem::last_write_time(*object, std::filesystem::file_time_type::clock::now()
+                                                          - std::chrono::seconds(3600 - newer_by_seconds));
+        }
+        return object.value_or(std::filesystem::path{});
+    }
+
+    void miss_and_hit() {
+        const auto root = cache_root("hit");
+        ArchiveCache cache(root);
+        const auto url = BASE_URL + "BTCUSDT-trades-2024-01.zip";
+        CHECK(!cache.lookup(url).has_value());
+
+        const auto object = commit(cache, url, '1', 16, 0);
+        CHECK(std::filesystem::file_size(object) == 16);
+        cache.release(object);
+
+        const auto hit = cache.lookup(url);
+        CHECK(hit.has_value() && *hit == object);
+        if (hit.has_value()) {
+            cache.release(*hit);
+        }
+        CHECK(!cache.lookup(BASE_URL + "BTCUSDT-trades-2024-02.zip").has_value());
+        // a reopened cache finds the same object through its ref
+        ArchiveCache reopened(root);
+        CHECK(reopened.lookup(url) == object);
+    }
+
+    void checksum_mismatch() {
+        ArchiveCache cache(cache_root("mismatch"));
+        const auto url = BASE_URL + "BTCUSDT-trades-2024-01.zip";
+        const auto staged = stage(cache, url, 16);
+        CHECK(!cache.commit(url, staged, digest('1'), digest('2')).has_value());
+        // the staged file is consumed either way and nothing is stored
+        CHECK(!std::filesystem::exists(staged));
+        CHECK(!cache.lookup(url).has_value());
+    }
+
+    void evicts_least_recently_used() {
+        ArchiveCache cache(cache_root("evict"), 100);
+        const auto old_url = BASE_URL + "BTCUSDT-trades-2024-01.zip";
+        const auto new_url = BASE_URL + "BTCUSDT-trades-2024-02.zip";
+        const auto old_object = commit(cache, old_url, '1', 60, 0);
+        cache.release(old_object);
+        const auto new_object = commit(cache, new_url, '2', 60, 10);
+        cache.release(new_object);
+        CHECK(!std::filesystem::exists(old_object));
+        CHECK(std::filesystem::exists(new_object));
+        // the dangling ref is a miss, not a path to a missing file
+        CHECK(!cache.lookup(old_url).has_value());
+    }
+
+    void pinned_objects_survive() {
+        ArchiveCache cache(cache_root("pinned"), 100);
+        const auto queued_url = BASE_URL + "BTCUSDT-trades-2024-01.zip";
+        // committed and still waiting to be parsed: pinned
+        const auto queued = commit(cache, queued_url, '1', 60, 0);
+        const auto newer = commit(cache, BASE_URL + "BTCUSDT-trades-2024-02.zip", '2', 60, 10);
+        CHECK(std::filesystem::exists(queued));
+        CHECK(std::filesystem::exists(newer));
+
+        // a lookup pins too, the object stays until both holders released it
+        const auto hit = cache.lookup(queued_url);
+        CHECK(hit == queued);
+        cache.release(queued);
+        CHECK(std::filesystem::exists(queued));
+        std::filesystem::last_write_time(queued, std::filesystem::file_time_type::clock::now() - std::chrono::hours(2));
+        cache.release(queued);
+        CHECK(!std::filesystem::exists(queued));
+        CHECK(std::filesystem::exists(newer));
+        cache.release(newer);
+        CHECK(std::filesystem::exists(newer));
+    }
+
+    void larger_than_max_bytes_survives_its_commit() {
+        ArchiveCache cache(cache_root("oversized"), 10);
+        const auto object = commit(cache, BASE_URL + "BTCUSDT-trades-2024-01.zip", '1', 60, 0);
+        CHECK(std::filesystem::exists(object));
+        cache.release(object);
+        CHECK(!std::filesystem::exists(object));
+    }
+}
+
+int main() {
+    miss_and_hit();
+    checksum_mismatch();
+    evicts_least_recently_used();
+    pinned_objects_survive();
+    larger_than_max_bytes_survives_its_commit();
+    for (const auto *name : {"hit", "mismatch", "evict", "pinned", "oversized"}) {
+        std::filesystem::remove_all(std::filesystem::temp_directory_path() / (std::string("archive_cache_test_") + name));
+    }
+    return test::exit_code();
+}
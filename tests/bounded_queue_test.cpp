@@ -0,0 +1,145 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// BoundedQueue overflow policies: the DROP_NEWEST / DROP_OLDEST counters and contents, and a BLOCK
+// producer parked on a full queue being woken by a dequeue or released by close().
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "common/sync/bounded_queue.h"
+#include "check.h"
+
+namespace {
+
+    using common::sync::BoundedQueue;
+    using common::sync::OverflowPolicy;
+
+    // long enough for a producer that is not going to be released to park
+    constexpr auto SETTLE = std::chrono::milliseconds(100);
+
+    std::vector<int> drain(BoundedQueue<int> &queue) {
+        std::vector<int> values;
+        for (int value; queue.try_dequeue(value);) {
+            values.push_back(value);
+        }
+        return values;
+    }
+
+    void drop_newest_counts_rejected_events() {
+        BoundedQueue<int> queue(4, OverflowPolicy::DROP_NEWEST);
+        for (int i = 0; i < 4; ++i) {
+            CHECK(queue.enqueue(int{i}));
+        }
+        CHECK(!queue.enqueue(4));
+        CHECK(!queue.enqueue(5));
+
+        auto counters = queue.counters();
+        CHECK(counters.depth == 4);
+        CHECK(counters.high_water == 4);
+        CHECK(counters.enqueued == 4);
+        CHECK(counters.dropped == 2);
+        CHECK(drain(queue) == std::vector<int>({0, 1, 2, 3}));
+
+        // a bulk takes what fits, the tail stays with the caller
+        CHECK(queue.enqueue(int{10}));
+        CHECK(queue.enqueue(int{11}));
+        std::vector<int> bulk{12, 13, 14, 15};
+        CHECK(queue.enqueue_bulk(bulk.begin(), bulk.size()) == 2);
+        counters = queue.counters();
+        CHECK(counters.enqueued == 8);
+        CHECK(counters.dequeued == 4);
+        CHECK(counters.dropped == 4);
+        CHECK(drain(queue) == std::vector<int>({10, 11, 12, 13}));
+        CHECK(queue.counters().depth == 0);
+    }
+
+    void drop_oldest_evicts_from_the_head() {
+        BoundedQueue<int> queue(4, OverflowPolicy::DROP_OLDEST);
+        for (int i = 0; i < 6; ++i) {
+            CHECK(queue.enqueue(int{i}));
+        }
+        auto counters = queue.counters();
+        CHECK(counters.depth == 4);
+        CHECK(counters.high_water == 4);
+        CHECK(counters.enqueued == 6);
+        CHECK(counters.dropped == 2);
+        CHECK(drain(queue) == std::vector<int>({2, 3, 4, 5}));
+
+        // a bulk as large as the queue replaces everything in it
+        CHECK(queue.enqueue(int{6}));
+        std::vector<int> bulk{7, 8, 9, 10};
+        CHECK(queue.enqueue_bulk(bulk.begin(), bulk.size()) == 4);
+        counters = queue.counters();
+        CHECK(counters.depth == 4);
+        CHECK(counters.enqueued == 11);
+        CHECK(counters.dropped == 3);
+        CHECK(drain(queue) == std::vector<int>({7, 8, 9, 10}));
+    }
+
+    void block_wakes_a_parked_producer() {
+        BoundedQueue<int> queue(2, OverflowPolicy::BLOCK);
+        CHECK(queue.enqueue(0));
+        CHECK(queue.enqueue(1));
+
+        std::atomic<bool> returned{false};
+        bool accepted = false;
+        std::thread producer([&] {
+            accepted = queue.enqueue(2);
+            returned.store(true);
+        });
+        std::this_thread::sleep_for(SETTLE);
+        CHECK(!returned.load());
+
+        int value = -1;
+        CHECK(queue.try_dequeue(value) && value == 0);
+        producer.join();
+        CHECK(accepted);
+
+        const auto counters = queue.counters();
+        CHECK(counters.depth == 2);
+        CHECK(counters.high_water == 2);
+        CHECK(counters.enqueued == 3);
+        CHECK(counters.dropped == 0);
+        CHECK(drain(queue) == std::vector<int>({1, 2}));
+    }
+
+    void block_admits_an_oversized_bulk_into_an_empty_queue() {
+        BoundedQueue<int> queue(2, OverflowPolicy::BLOCK);
+        std::vector<int> bulk{0, 1, 2, 3, 4};
+        CHECK(queue.enqueue_bulk(bulk.begin(), bulk.size()) == 5);
+        CHECK(queue.counters().high_water == 5);
+        CHECK(drain(queue) == std::vector<int>({0, 1, 2, 3, 4}));
+    }
+
+    void close_releases_a_parked_producer() {
+        BoundedQueue<int> queue(1, OverflowPolicy::BLOCK);
+        CHECK(queue.enqueue(0));
+
+        std::atomic<bool> returned{false};
+        bool accepted = true;
+        std::thread producer([&] {
+            accepted = queue.enqueue(1);
+            returned.store(true);
+        });
+        std::this_thread::sleep_for(SETTLE);
+        CHECK(!returned.load());
+
+        queue.close();
+        producer.join();
+        CHECK(!accepted);
+        CHECK(queue.counters().dropped == 1);
+        CHECK(drain(queue) == std::vector<int>({0}));
+    }
+}
+
+int main() {
+    drop_newest_counts_rejected_events();
+    drop_oldest_evicts_from_the_head();
+    block_wakes_a_parked_producer();
+    block_admits_an_oversized_bulk_into_an_empty_queue();
+    close_releases_a_parked_producer();
+    return test::exit_code();
+}
@@ -0,0 +1,28 @@
+//
+// Created by jtwears on 10/17/26.
+//
+
+#pragma once
+
+#include <iostream>
+
+// Minimal assertions for the plain-main test executables run by ctest: a failed CHECK prints
+// its location and makes the executable exit non-zero once main returns test::exit_code().
+namespace test {
+    inline int failures = 0;
+
+    inline int exit_code() {
+        if (failures > 0) {
+            std::cerr << failures << " check(s) failed" << std::endl;
+        }
+        return failures == 0 ? 0 : 1;
+    }
+}
+
+#define CHECK(condition)                                                                              \
+    do {                                                                                              \
+        if (!(condition)) {                                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+            ++test::failures;                                                                         \
+        }                                                                                             \
+    } while (0)
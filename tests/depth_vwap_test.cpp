@@ -0,0 +1,65 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// depth_vwap: notional at the notional_codec scale and VWAP at the price scale for run time precisions,
+// empty sides, unsupported precisions and a notional that overflows.
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "common/io/depth_vwap.h"
+#include "common/reference/reference_data_service.h"
+#include "check.h"
+
+namespace {
+
+    using common::io::depth_vwap;
+    using common::models::PriceLevel;
+
+    void btcusdt_levels() {
+        // 0.10 tick, 0.001 step: 67000.10 x 0.500 and 67000.00 x 1.500
+        const std::vector<PriceLevel> bids{{6'700'010, 500}, {6'700'000, 1'500}};
+        const auto vwap = depth_vwap(bids.data(), bids.size(), 2, 3);
+        CHECK(vwap.has_value());
+        // 134000.05 at 5 digits, below ARCHIVE_PRECISION, so widened to 8 like a trade's quote_qty
+        CHECK(vwap->notional == 13'400'005'000'000);
+        // 67000.025 rounds half away from zero
+        CHECK(vwap->vwap == 6'700'003);
+    }
+
+    void matches_the_notional_codec() {
+        common::reference::ReferenceDataService reference_data;
+        const auto symbol = reference_data.add("1000PEPEUSDT", 7, 0);
+        const std::vector<PriceLevel> asks{{123'456, 10}, {123'460, 30}};
+        const auto vwap = depth_vwap(asks.data(), asks.size(), reference_data.price_codec(symbol).precision,
+                                     reference_data.quantity_codec(symbol).precision);
+        CHECK(vwap.has_value());
+        // 0.0123456 * 10 + 0.012346 * 30
+        CHECK(reference_data.notional_codec(symbol).precision == 8);
+        CHECK(vwap->notional == 49'383'600);
+        CHECK(vwap->vwap == 123'459);
+    }
+
+    void empty_and_unsupported() {
+        CHECK(!depth_vwap(nullptr, 0, 2, 3).has_value());
+        const std::vector<PriceLevel> zero_quantity{{100, 0}};
+        CHECK(!depth_vwap(zero_quantity.data(), zero_quantity.size(), 2, 3).has_value());
+        const std::vector<PriceLevel> levels{{100, 1}};
+        CHECK(!depth_vwap(levels.data(), levels.size(), 9, 3).has_value());
+        CHECK(!depth_vwap(levels.data(), levels.size(), 2, -1).has_value());
+    }
+
+    void overflow_is_empty() {
+        const std::vector<PriceLevel> levels{{std::numeric_limits<int64_t>::max() / 2, 3}};
+        CHECK(!depth_vwap(levels.data(), levels.size(), 2, 3).has_value());
+    }
+}
+
+int main() {
+    btcusdt_levels();
+    matches_the_notional_codec();
+    empty_and_unsupported();
+    overflow_is_empty();
+    return test::exit_code();
+}
@@ -0,0 +1,143 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// DecimalCodec parsing: exact mantissas, trailing zero padding, rounding of digits beyond the scale
+// and the int64 range limits. FixedPoint rescaling, checked arithmetic and Vwap.
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+#include "common/rounding/fixed_point.h"
+#include "check.h"
+
+namespace {
+
+    using common::rounding::decimal_codec;
+    using common::rounding::FixedPoint;
+    using common::rounding::Vwap;
+
+    using Price2 = FixedPoint<int64_t, 2>;
+    using Quantity3 = FixedPoint<int64_t, 3>;
+
+    template<typename Fn>
+    bool throws(Fn fn) {
+        try {
+            fn();
+        } catch (const std::exception &) {
+            return true;
+        }
+        return false;
+    }
+
+    bool parses(const int precision, const std::string_view s, const int64_t expected) {
+        int64_t out = 0;
+        return decimal_codec<int64_t>(precision).parse(s, out) && out == expected;
+    }
+
+    bool rounds(const int precision, const std::string_view s, const int64_t expected) {
+        int64_t out = 0;
+        return decimal_codec<int64_t>(precision).parse_rounded(s, out) && out == expected;
+    }
+
+    bool rejects(const int precision, const std::string_view s) {
+        int64_t out = 0;
+        return !decimal_codec<int64_t>(precision).parse(s, out);
+    }
+
+    bool rejects_rounded(const int precision, const std::string_view s) {
+        int64_t out = 0;
+        return !decimal_codec<int64_t>(precision).parse_rounded(s, out);
+    }
+
+    void exact_parse() {
+        CHECK(parses(2, "42000.10", 4'200'010));
+        CHECK(parses(2, "42000.1", 4'200'010));
+        CHECK(parses(2, "42000", 4'200'000));
+        CHECK(parses(3, "-0.005", -5));
+        CHECK(parses(3, "+1.5", 1'500));
+        CHECK(parses(0, "7", 7));
+        // zeros past the scale are padding
+        CHECK(parses(2, "1.2300000000", 123));
+        CHECK(parses(8, "0.00000001", 1));
+
+        CHECK(rejects(2, "1.234"));
+        CHECK(rejects(2, ""));
+        CHECK(rejects(2, "-"));
+        CHECK(rejects(2, "1.2.3"));
+        CHECK(rejects(2, "1e5"));
+        CHECK(rejects(2, "abc"));
+    }
+
+    void rounded_parse() {
+        // half away from zero on the first dropped digit
+        CHECK(rounds(2, "1.234", 123));
+        CHECK(rounds(2, "1.235", 124));
+        CHECK(rounds(2, "1.2349999", 123));
+        CHECK(rounds(2, "-1.235", -124));
+        CHECK(rounds(2, "-1.234", -123));
+        CHECK(rounds(0, "0.5", 1));
+        CHECK(rounds(2, "0.999", 100));
+        // exact input is unchanged
+        CHECK(rounds(2, "42000.10", 4'200'010));
+        CHECK(rejects_rounded(2, "1.2x"));
+    }
+
+    void range_limits() {
+        constexpr auto max = std::numeric_limits<int64_t>::max();
+        CHECK(parses(0, "9223372036854775807", max));
+        CHECK(parses(0, "-9223372036854775807", -max));
+        CHECK(rejects(0, "9223372036854775808"));
+        CHECK(parses(8, "92233720368.54775807", max));
+        CHECK(rejects(8, "92233720368.54775808"));
+        // rounding up past the range fails instead of wrapping
+        CHECK(rejects_rounded(0, "9223372036854775807.5"));
+        CHECK(rounds(0, "9223372036854775806.5", max));
+    }
+
+    void fixed_point_arithmetic() {
+        static_assert(Price2::ONE == 100);
+        static_assert((Price2::from_raw(150) + Price2::from_raw(25)).raw() == 175);
+        static_assert((Price2::from_raw(4'200'010) * Quantity3::from_raw(1'500)).raw() == 6'300'015'000);
+        CHECK(Price2::from_string("42000.10").raw() == 4'200'010);
+        CHECK(throws([] { (void) Price2::from_string("1.234"); }));
+        CHECK(Price2::from_double(-2.5).raw() == -250);
+        CHECK(throws([] { (void) Price2::from_double(1e300); }));
+
+        // widening is exact, narrowing rounds half away from zero
+        CHECK(Price2::from_raw(123).rescale<4>().raw() == 12'300);
+        CHECK(Price2::from_raw(125).rescale<1>().raw() == 13);
+        CHECK(Price2::from_raw(-125).rescale<1>().raw() == -13);
+        CHECK(Price2::from_raw(124).rescale<1>().raw() == 12);
+
+        constexpr auto max = std::numeric_limits<int64_t>::max();
+        CHECK(throws([] { (void) (Price2::from_raw(std::numeric_limits<int64_t>::max()) + Price2::from_raw(1)); }));
+        CHECK(throws([] { (void) (Price2::from_raw(std::numeric_limits<int64_t>::min()) - Price2::from_raw(1)); }));
+        CHECK(throws([] { (void) (Price2::from_raw(max / 2 + 1) * Quantity3::from_raw(2)); }));
+        CHECK(throws([] { (void) Price2::from_raw(max / 10 + 1).rescale<3>(); }));
+        CHECK(throws([] { (void) (FixedPoint<int64_t, 5>::from_raw(1) / Quantity3::from_raw(0)); }));
+    }
+
+    void vwap() {
+        // 2 @ 100.00 and 1 @ 102.00: 302.00 notional over 3, 100.666.. rounds to 100.67
+        Vwap<int64_t, 2, 3> vwap;
+        vwap.add(Price2::from_string("100"), Quantity3::from_string("2"));
+        vwap.add(Price2::from_string("102"), Quantity3::from_string("1"));
+        CHECK(vwap.notional().raw() == 30'200'000);
+        CHECK(vwap.quantity().raw() == 3'000);
+        CHECK(vwap.value().raw() == 10'067);
+
+        Vwap<int64_t, 2, 3> empty;
+        CHECK(throws([&] { (void) empty.value(); }));
+    }
+}
+
+int main() {
+    exact_parse();
+    rounded_parse();
+    range_limits();
+    fixed_point_arithmetic();
+    vwap();
+    return test::exit_code();
+}
@@ -0,0 +1,137 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// FlushTuner against a modelled server: a fixed budget stays put, auto tuning climbs to the knee of
+// the throughput curve and stays around it, and the target never leaves [minBytes, maxBytes] or keeps
+// flushes above maxLatency.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "common/io/flush_tuner.h"
+#include "check.h"
+
+namespace {
+
+    using common::io::FlushBudget;
+    using common::io::FlushTuner;
+    using common::io::FLUSH_TUNER_WINDOW;
+
+    constexpr size_t MIB = 1024 * 1024;
+    constexpr double STEP = 1.25;
+    constexpr size_t WINDOWS = 400;
+
+    // a flush costs a round trip plus the transfer; past knee_bytes the server falls behind and every
+    // further byte costs four times as much, so throughput peaks at the knee
+    struct Server {
+        double round_trip_seconds = 0.005;
+        double bytes_per_second = 2.0 * 1024 * MIB;
+        double knee_bytes = 16.0 * MIB;
+
+        [[nodiscard]] std::chrono::steady_clock::duration latency(const size_t bytes) const {
+            const double size = static_cast<double>(bytes);
+            double seconds = round_trip_seconds + size / bytes_per_second;
+            if (size > knee_bytes) {
+                seconds += 4 * (size - knee_bytes) / bytes_per_second;
+            }
+            return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+        }
+    };
+
+    // feeds windows of flushes of the current target, like a flusher whose buffers fill up to it,
+    // and returns the smallest and largest target seen over the last settle windows
+    std::pair<size_t, size_t> run(FlushTuner &tuner, const Server &server, const size_t windows, const size_t settle) {
+        size_t low = SIZE_MAX;
+        size_t high = 0;
+        for (size_t w = 0; w < windows; ++w) {
+            for (size_t f = 0; f < FLUSH_TUNER_WINDOW; ++f) {
+                const size_t bytes = tuner.target();
+                tuner.observe(bytes, server.latency(bytes));
+            }
+            if (w + settle >= windows) {
+                low = std::min(low, tuner.target());
+                high = std::max(high, tuner.target());
+            }
+        }
+        return {low, high};
+    }
+
+    void fixed_budget_never_moves() {
+        FlushBudget budget;
+        budget.bytes = 3 * MIB;
+        budget.minBytes = 4 * MIB; // only clamps once tuning is on
+        FlushTuner tuner(budget, std::chrono::seconds(1));
+        CHECK(tuner.target() == 3 * MIB);
+        const auto [low, high] = run(tuner, Server{}, 50, 50);
+        CHECK(low == 3 * MIB && high == 3 * MIB);
+    }
+
+    void converges_on_the_knee() {
+        const Server server;
+        for (const size_t start : {MIB / 16, 60 * MIB}) {
+            FlushBudget budget;
+            budget.bytes = start;
+            budget.autoTune = true;
+            budget.minBytes = 16 * 1024;
+            budget.maxBytes = 64 * MIB;
+            FlushTuner tuner(budget, std::chrono::seconds(1));
+            const auto [low, high] = run(tuner, server, WINDOWS, 100);
+            // settled within a couple of steps either side of the knee, from below and from above
+            CHECK(static_cast<double>(low) >= server.knee_bytes / (STEP * STEP));
+            CHECK(static_cast<double>(high) <= server.knee_bytes * STEP * STEP);
+        }
+    }
+
+    void clamps_to_the_budget_bounds() {
+        // the curve still rises at maxBytes, the target pins there
+        FlushBudget budget;
+        budget.bytes = 1 * MIB;
+        budget.autoTune = true;
+        budget.minBytes = 512 * 1024;
+        budget.maxBytes = 4 * MIB;
+        FlushTuner rising(budget, std::chrono::seconds(1));
+        size_t highest = 0;
+        for (size_t w = 0; w < WINDOWS; ++w) {
+            const auto [low, high] = run(rising, Server{}, 1, 1);
+            CHECK(low >= budget.minBytes);
+            highest = std::max(highest, high);
+        }
+        CHECK(highest == budget.maxBytes);
+
+        // every flush is over maxLatency, the target sinks to minBytes and stays
+        FlushTuner slow(budget, std::chrono::microseconds(1));
+        const auto [low, high] = run(slow, Server{}, WINDOWS, 100);
+        CHECK(low == budget.minBytes && high == budget.minBytes);
+
+        // a starting budget outside the bounds is clamped before the first flush
+        budget.bytes = 64 * MIB;
+        CHECK(FlushTuner(budget, std::chrono::seconds(1)).target() == budget.maxBytes);
+        budget.bytes = 1024;
+        CHECK(FlushTuner(budget, std::chrono::seconds(1)).target() == budget.minBytes);
+    }
+
+    void backs_off_above_max_latency() {
+        // the knee is at 16 MiB, but a flush of more than ~10 MiB takes longer than 10ms
+        const Server server;
+        FlushBudget budget;
+        budget.bytes = 1 * MIB;
+        budget.autoTune = true;
+        budget.maxBytes = 64 * MIB;
+        FlushTuner tuner(budget, std::chrono::milliseconds(10));
+        const auto [low, high] = run(tuner, server, WINDOWS, 100);
+        // only ever one step over the latency bound before it shrinks again
+        CHECK(server.latency(static_cast<size_t>(static_cast<double>(high) / STEP)) <= std::chrono::milliseconds(10));
+        CHECK(low > 1 * MIB);
+    }
+}
+
+int main() {
+    fixed_budget_never_moves();
+    converges_on_the_knee();
+    clamps_to_the_budget_bounds();
+    backs_off_above_max_latency();
+    return test::exit_code();
+}
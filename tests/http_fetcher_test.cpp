@@ -0,0 +1,320 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// HttpFetcher against a scripted local HTTP server: dropped connections resumed with Range,
+// a 200 that ignores Range, parallel ranged downloads and the 4xx / 408 / 429 / 5xx retry rules.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "binancehistoricaldatafetcher/http_fetcher.h"
+#include "check.h"
+
+namespace {
+
+    struct Request {
+        std::string method;
+        std::string path;
+        std::optional<std::pair<uint64_t, std::optional<uint64_t>>> range; // first, last
+    };
+
+    // what a handler wants sent back; the body is cut after truncate_at bytes to fake a dropped connection
+    struct Response {
+        int status;
+        std::string body;
+        std::optional<size_t> truncate_at{};
+        uint64_t content_range_first = 0;
+        uint64_t total_length = 0;
+    };
+
+    // Serves one connection at a time and closes each one after the response. Handlers get the request
+    // and how many requests the same path has seen before it.
+    class ScriptedServer {
+        using Handler = std::function<Response(const Request &, int)>;
+
+        int listen_fd_ = -1;
+        uint16_t port_ = 0;
+        std::atomic<bool> running_{true};
+        std::thread thread_;
+        std::mutex mutex_;
+        std::map<std::string, Handler> handlers_;
+        std::map<std::string, std::vector<Request>> requests_;
+
+    public:
+        ScriptedServer() {
+            listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+            constexpr int enable = 1;
+            ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0;
+            ::bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+            ::listen(listen_fd_, 16);
+            socklen_t length = sizeof(address);
+            ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&address), &length);
+            port_ = ntohs(address.sin_port);
+            thread_ = std::thread([this] { serve(); });
+        }
+
+        ~ScriptedServer() {
+            running_.store(false);
+            ::shutdown(listen_fd_, SHUT_RDWR);
+            ::close(listen_fd_);
+            thread_.join();
+        }
+
+        void on(const std::string &path, Handler handler) {
+            std::lock_guard lock(mutex_);
+            handlers_[path] = std::move(handler);
+        }
+
+        [[nodiscard]] std::string url(const std::string &path) const {
+            return "http://127.0.0.1:" + std::to_string(port_) + path;
+        }
+
+        [[nodiscard]] std::vector<Request> requests(const std::string &path) {
+            std::lock_guard lock(mutex_);
+            return requests_[path];
+        }
+
+    private:
+        void serve() {
+            while (running_.load()) {
+                const int fd = ::accept(listen_fd_, nullptr, nullptr);
+                if (fd < 0) {
+                    continue;
+                }
+                handle(fd);
+                ::close(fd);
+            }
+        }
+
+        void handle(const int fd) {
+            std::string head;
+            char c;
+            while (!head.ends_with("\r\n\r\n") && ::recv(fd, &c, 1, 0) == 1) {
+                head.push_back(c);
+            }
+            Request request;
+            const auto first_space = head.find(' ');
+            const auto second_space = head.find(' ', first_space + 1);
+            if (first_space == std::string::npos || second_space == std::string::npos) {
+                return;
+            }
+            request.method = head.substr(0, first_space);
+            request.path = head.substr(first_space + 1, second_space - first_space - 1);
+            if (const auto range = head.find("Range: bytes="); range != std::string::npos) {
+                const auto begin = range + 13;
+                const auto dash = head.find('-', begin);
+                const auto end = head.find("\r\n", dash);
+                request.range.emplace(std::stoull(head.substr(begin, dash - begin)), std::nullopt);
+                if (end > dash + 1) {
+                    request.range->second = std::stoull(head.substr(dash + 1, end - dash - 1));
+                }
+            }
+
+            Handler handler;
+            int seen;
+            {
+                std::lock_guard lock(mutex_);
+                auto &seen_requests = requests_[request.path];
+                seen = static_cast<int>(seen_requests.size());
+                seen_requests.push_back(request);
+                handler = handlers_[request.path];
+            }
+            const Response response = handler ? handler(request, seen) : Response{404, "not found"};
+
+            std::string reply = "HTTP/1.1 " + std::to_string(response.status) + " Scripted\r\n";
+            reply += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+            reply += "Accept-Ranges: bytes\r\n";
+            if (response.status == 206) {
+                reply += "Content-Range: bytes " + std::to_string(response.content_range_first) + "-"
+                    + std::to_string(response.content_range_first + response.body.size() - 1) + "/"
+                    + std::to_string(response.total_length) + "\r\n";
+            }
+            reply += "Connection: close\r\n\r\n";
+            if (request.method != "HEAD") {
+                reply += response.truncate_at.has_value() ? response.body.substr(0, *response.truncate_at) : response.body;
+            }
+            for (size_t sent = 0; sent < reply.size();) {
+                const auto n = ::send(fd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) {
+                    break;
+                }
+                sent += static_cast<size_t>(n);
+            }
+        }
+    };
+
+    std::string make_body(const size_t size) {
+        std::string body(size, '\0');
+        for (size_t i = 0; i < size; ++i) {
+            body[i] = static_cast<char>('a' + (i * 7 + i / 251) % 26);
+        }
+        return body;
+    }
+
+    // honours Range like a well behaved server
+    Response serve_range(const std::string &body, const Request &request) {
+        if (!request.range.has_value()) {
+            return {200, body};
+        }
+        const auto first = request.range->first;
+        const auto last = request.range->second.value_or(body.size() - 1);
+        return {206, body.substr(first, last - first + 1), std::nullopt, first, body.size()};
+    }
+
+    downloader::HttpFetcherOptions fast_retries() {
+        downloader::HttpFetcherOptions options;
+        options.max_attempts = 3;
+        options.base_backoff = std::chrono::milliseconds(1);
+        options.max_backoff = std::chrono::milliseconds(5);
+        options.range_split_bytes = 0;
+        return options;
+    }
+
+    std::optional<std::string> fetch(const downloader::HttpFetcher &fetcher, const std::string &url, uint64_t &bytes) {
+        std::string received;
+        if (!fetcher.fetch(url, [&](const std::string_view data) { received.append(data); return true; }, bytes)) {
+            return std::nullopt;
+        }
+        return received;
+    }
+
+    void resumes_dropped_transfer_with_range(ScriptedServer &server) {
+        const auto body = make_body(300'000);
+        server.on("/resume", [&](const Request &request, const int seen) {
+            auto response = serve_range(body, request);
+            // the first two attempts drop part way through
+            if (seen < 2) {
+                response.truncate_at = response.body.size() / 3;
+            }
+            return response;
+        });
+        const downloader::HttpFetcher fetcher(fast_retries());
+        uint64_t bytes = 0;
+        const auto received = fetch(fetcher, server.url("/resume"), bytes);
+        CHECK(received.has_value() && *received == body);
+        CHECK(bytes == body.size());
+
+        const auto requests = server.requests("/resume");
+        CHECK(requests.size() == 3);
+        CHECK(!requests[0].range.has_value());
+        // every retry starts at the first byte the consumer does not have yet
+        const uint64_t first_cut = body.size() / 3;
+        CHECK(requests[1].range.has_value() && requests[1].range->first == first_cut && !requests[1].range->second);
+        CHECK(requests[2].range.has_value() && requests[2].range->first == first_cut + (body.size() - first_cut) / 3);
+    }
+
+    void skips_resent_prefix_when_range_is_ignored(ScriptedServer &server) {
+        const auto body = make_body(200'000);
+        server.on("/ignore-range", [&](const Request &, const int seen) {
+            Response response{200, body};
+            if (seen == 0) {
+                response.truncate_at = 70'001;
+            }
+            return response;
+        });
+        const downloader::HttpFetcher fetcher(fast_retries());
+        uint64_t bytes = 0;
+        const auto received = fetch(fetcher, server.url("/ignore-range"), bytes);
+        // the full body is resent, the consumer still sees every byte exactly once
+        CHECK(received.has_value() && *received == body);
+        CHECK(bytes == body.size());
+        const auto requests = server.requests("/ignore-range");
+        CHECK(requests.size() == 2);
+        CHECK(requests.size() == 2 && requests[1].range.has_value() && requests[1].range->first == 70'001);
+    }
+
+    void rejects_ignored_range_for_parallel_ranges(ScriptedServer &server) {
+        const auto body = make_body(100'000);
+        server.on("/ranged-200", [&](const Request &, int) { return Response{200, body}; });
+        auto options = fast_retries();
+        options.range_split_bytes = 10'000;
+        options.range_connections = 4;
+        const downloader::HttpFetcher fetcher(options);
+        const auto path = std::filesystem::temp_directory_path() / "http_fetcher_test_ranged_200.bin";
+        uint64_t bytes = 0;
+        // a whole body written at every range offset would corrupt the file, so the download fails instead
+        CHECK(!fetcher.fetch_to_file(server.url("/ranged-200"), path, nullptr, bytes));
+        std::filesystem::remove(path);
+    }
+
+    void downloads_parallel_ranges_with_drops(ScriptedServer &server) {
+        const auto body = make_body(400'003);
+        server.on("/ranged", [&](const Request &request, const int seen) {
+            auto response = serve_range(body, request);
+            // drop every other ranged GET half way, the HEAD probe is request 0
+            if (request.method == "GET" && seen % 2 == 1) {
+                response.truncate_at = response.body.size() / 2;
+            }
+            return response;
+        });
+        auto options = fast_retries();
+        options.range_split_bytes = 50'000;
+        options.range_connections = 4;
+        const downloader::HttpFetcher fetcher(options);
+        const auto path = std::filesystem::temp_directory_path() / "http_fetcher_test_ranged.bin";
+        uint64_t bytes = 0;
+        CHECK(fetcher.fetch_to_file(server.url("/ranged"), path, nullptr, bytes));
+        CHECK(bytes == body.size());
+        std::ifstream file(path, std::ios::binary);
+        const std::string written((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        CHECK(written == body);
+        std::filesystem::remove(path);
+    }
+
+    void classifies_statuses(ScriptedServer &server) {
+        const auto body = make_body(1'000);
+        const downloader::HttpFetcher fetcher(fast_retries());
+
+        // client errors are final, a single request
+        server.on("/403", [](const Request &, int) { return Response{403, "forbidden"}; });
+        uint64_t bytes = 0;
+        CHECK(!fetch(fetcher, server.url("/403"), bytes).has_value());
+        CHECK(server.requests("/403").size() == 1);
+        CHECK(!fetch(fetcher, server.url("/missing"), bytes).has_value());
+        CHECK(server.requests("/missing").size() == 1);
+
+        // timeouts and rate limits are retried, the error page never reaches the consumer
+        for (const int status : {408, 429, 503}) {
+            const auto path = "/" + std::to_string(status);
+            server.on(path, [&, status](const Request &, const int seen) {
+                return seen == 0 ? Response{status, "try again"} : Response{200, body};
+            });
+            const auto received = fetch(fetcher, server.url(path), bytes);
+            CHECK(received.has_value() && *received == body);
+            CHECK(server.requests(path).size() == 2);
+        }
+
+        // retries stop after max_attempts without progress
+        server.on("/500", [](const Request &, int) { return Response{500, "broken"}; });
+        CHECK(!fetch(fetcher, server.url("/500"), bytes).has_value());
+        CHECK(server.requests("/500").size() == static_cast<size_t>(fast_retries().max_attempts));
+    }
+}
+
+int main() {
+    ScriptedServer server;
+    resumes_dropped_transfer_with_range(server);
+    skips_resent_prefix_when_range_is_ignored(server);
+    rejects_ignored_range_for_parallel_ranges(server);
+    downloads_parallel_ranges_with_drops(server);
+    classifies_statuses(server);
+    return test::exit_code();
+}
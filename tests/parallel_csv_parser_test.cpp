@@ -0,0 +1,97 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// ParallelCsvParser keeps row order across windows and slices, and parses every window on the
+// same set of threads.
+
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/parsing/number_parser.h"
+#include "common/parsing/parallel_csv_parser.h"
+#include "check.h"
+
+namespace {
+
+    constexpr size_t ROWS = 200'000;
+
+    std::string make_csv() {
+        std::string csv;
+        for (size_t i = 0; i < ROWS; ++i) {
+            csv += std::to_string(i) + ",x," + std::to_string(i * 3) + "\n";
+        }
+        return csv;
+    }
+
+    void keeps_row_order_on_persistent_workers(const size_t threads) {
+        const auto csv = make_csv();
+        std::vector<int64_t> ids;
+        std::mutex mutex;
+        std::set<std::thread::id> parse_threads;
+        size_t slices = 0;
+        {
+            auto parser = common::parsing::make_parallel_csv_parser<4, std::vector<int64_t>>(
+                threads,
+                4096, // small slices, so the file spans many windows
+                [&](const std::span<const std::string_view> fields, std::vector<int64_t> &batch) {
+                    int64_t id = -1;
+                    CHECK(fields.size() == 3 && common::parsing::parse_int64(fields[0], id));
+                    batch.push_back(id);
+                    std::lock_guard lock(mutex);
+                    parse_threads.insert(std::this_thread::get_id());
+                },
+                [&](std::vector<int64_t> &batch) {
+                    ids.insert(ids.end(), batch.begin(), batch.end());
+                    ++slices;
+                });
+            // odd chunk sizes split rows across feed calls
+            for (size_t offset = 0; offset < csv.size(); offset += 1531) {
+                parser.feed(std::string_view(csv).substr(offset, 1531));
+            }
+            parser.finish();
+        }
+        CHECK(ids.size() == ROWS);
+        bool ordered = true;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            ordered = ordered && ids[i] == static_cast<int64_t>(i);
+        }
+        CHECK(ordered);
+        CHECK(slices / threads > 100);
+        // the feeding thread plus the workers started with the parser, never a thread per window
+        CHECK(parse_threads.size() <= threads);
+    }
+
+    void rethrows_parse_errors() {
+        bool thrown = false;
+        try {
+            auto parser = common::parsing::make_parallel_csv_parser<4, int>(
+                4, 64,
+                [](const std::span<const std::string_view> fields, int &) {
+                    if (fields[0] == "bad") {
+                        throw std::runtime_error("bad row");
+                    }
+                },
+                [](int &) {});
+            std::string csv;
+            for (int i = 0; i < 100; ++i) {
+                csv += i == 77 ? "bad\n" : "good\n";
+            }
+            parser.feed(csv);
+            parser.finish();
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+}
+
+int main() {
+    keeps_row_order_on_persistent_workers(1);
+    keeps_row_order_on_persistent_workers(4);
+    rethrows_parse_errors();
+    return test::exit_code();
+}
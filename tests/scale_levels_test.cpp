@@ -0,0 +1,107 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// scale_levels against the plain cast and DecimalCodec::to_double, bit for bit: at small and 2^51
+// boundary mantissas of either sign, over random books at every exchange precision, and out to the
+// int64 limits, where the conversion itself rounds.
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "common/io/scale_levels.h"
+#include "common/rounding/fixed_point.h"
+#include "check.h"
+
+namespace {
+
+    using common::io::scale_levels;
+    using common::models::PriceLevel;
+    using common::rounding::decimal_codec;
+
+    constexpr int64_t TWO_POW_51 = int64_t{1} << 51;
+
+    // every output equals the plain cast and the codec, the same double to the bit
+    bool matches(const std::vector<PriceLevel> &levels, const int price_precision, const int quantity_precision) {
+        const auto &price = decimal_codec<int64_t>(price_precision);
+        const auto &quantity = decimal_codec<int64_t>(quantity_precision);
+        std::vector<double> out(levels.size() * 2, -1.0);
+        scale_levels(levels.data(), levels.size(), price.divisor, quantity.divisor, out.data());
+        bool ok = true;
+        for (size_t i = 0; i < levels.size(); ++i) {
+            ok &= out[2 * i] == static_cast<double>(levels[i].price) / price.divisor;
+            ok &= out[2 * i] == price.to_double(levels[i].price);
+            ok &= out[2 * i + 1] == static_cast<double>(levels[i].quantity) / quantity.divisor;
+            ok &= out[2 * i + 1] == quantity.to_double(levels[i].quantity);
+        }
+        return ok;
+    }
+
+    void boundary_mantissas() {
+        const std::vector<PriceLevel> edges{
+            {0, 0},
+            {1, -1},
+            {TWO_POW_51 - 1, -TWO_POW_51},
+            {-TWO_POW_51, TWO_POW_51 - 1},
+            {-(TWO_POW_51 - 1), 1},
+            {-1, TWO_POW_51 - 2},
+        };
+        for (const int precision : {0, 1, 2, 8, 18}) {
+            CHECK(matches(edges, precision, 8 - precision % 9));
+        }
+        // and each edge as a book of its own
+        for (const auto &level : edges) {
+            CHECK(matches({level}, 2, 3));
+        }
+    }
+
+    void random_books() {
+        std::mt19937_64 rng(20261017);
+        std::uniform_int_distribution<int64_t> mantissa(-TWO_POW_51, TWO_POW_51 - 1);
+        std::uniform_int_distribution<int64_t> realistic(0, 10'000'000'000);
+        for (int precision = 0; precision <= 8; ++precision) {
+            for (const size_t depth : {1, 20, 100, 1000}) {
+                std::vector<PriceLevel> levels(depth);
+                for (auto &level : levels) {
+                    level = {realistic(rng), realistic(rng)};
+                }
+                CHECK(matches(levels, precision, 8 - precision));
+                for (auto &level : levels) {
+                    level = {mantissa(rng), mantissa(rng)};
+                }
+                CHECK(matches(levels, precision, 8 - precision));
+            }
+        }
+    }
+
+    void beyond_exact_doubles() {
+        constexpr int64_t MIN = std::numeric_limits<int64_t>::min();
+        constexpr int64_t MAX = std::numeric_limits<int64_t>::max();
+        // one mantissa past 2^51 or 2^53, or at the int64 limits, in an otherwise ordinary book
+        for (const int64_t outlier : {TWO_POW_51, -TWO_POW_51 - 1, (int64_t{1} << 53) + 1, MAX, MIN}) {
+            std::vector<PriceLevel> levels(100);
+            for (size_t i = 0; i < levels.size(); ++i) {
+                levels[i] = {static_cast<int64_t>(i) * 1'000 - 7, TWO_POW_51 - 1 - static_cast<int64_t>(i)};
+            }
+            levels[42].price = outlier;
+            CHECK(matches(levels, 2, 8));
+            levels[42] = {5, outlier};
+            CHECK(matches(levels, 2, 8));
+        }
+    }
+
+    void empty_book_writes_nothing() {
+        double sentinel = 3.5;
+        scale_levels(nullptr, 0, 100.0, 1000.0, &sentinel);
+        CHECK(sentinel == 3.5);
+    }
+}
+
+int main() {
+    boundary_mantissas();
+    random_books();
+    beyond_exact_doubles();
+    empty_book_writes_nothing();
+    return test::exit_code();
+}
@@ -0,0 +1,174 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// Spool: FIFO order across segments, replay after a reopen with consumed and pending records, a torn
+// tail record, the maxBytes budget and records larger than a segment.
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "common/io/spool.h"
+#include "check.h"
+
+namespace {
+
+    using common::io::Spool;
+
+    // 24 byte header, "record-N" padded to 39 bytes and a one digit meta: 64 byte records, two to a 128 byte segment
+    constexpr size_t SEGMENT_BYTES = 128;
+    constexpr size_t PAYLOAD_BYTES = 39;
+
+    std::filesystem::path spool_dir(const std::string &name) {
+        const auto dir = std::filesystem::temp_directory_path() / ("spool_test_" + name);
+        std::filesystem::remove_all(dir);
+        return dir;
+    }
+
+    std::string payload(const int i) {
+        auto value = "record-" + std::to_string(i);
+        value.resize(PAYLOAD_BYTES, '.');
+        return value;
+    }
+
+    size_t segment_files(const std::filesystem::path &dir) {
+        size_t count = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+            count += entry.path().extension() == ".spool";
+        }
+        return count;
+    }
+
+    // pops every record, true if they come out as payload(first) .. payload(last)
+    bool drains_in_order(Spool &spool, const int first, const int last) {
+        bool ok = true;
+        for (int i = first; i <= last; ++i) {
+            const auto record = spool.front();
+            ok &= record.has_value() && record->payload == payload(i) && record->meta == std::to_string(i);
+            spool.pop();
+        }
+        return ok && !spool.front().has_value() && spool.empty();
+    }
+
+    void order_across_segments() {
+        const auto dir = spool_dir("order");
+        Spool spool(dir, 1 << 20, SEGMENT_BYTES);
+        for (int i = 0; i < 7; ++i) {
+            CHECK(spool.append(payload(i), std::to_string(i)));
+        }
+        CHECK(spool.stats().records == 7);
+        CHECK(spool.stats().bytes == 7 * PAYLOAD_BYTES);
+        CHECK(segment_files(dir) == 4);
+        CHECK(drains_in_order(spool, 0, 6));
+        const auto stats = spool.stats();
+        CHECK(stats.spooled == 7 && stats.replayed == 7 && stats.dropped == 0);
+        // consumed segments are deleted, only the one appends continue in is left
+        CHECK(segment_files(dir) == 1);
+    }
+
+    void reopen_with_consumed_and_pending() {
+        const auto dir = spool_dir("reopen");
+        {
+            Spool spool(dir, 1 << 20, SEGMENT_BYTES);
+            for (int i = 0; i < 6; ++i) {
+                CHECK(spool.append(payload(i), std::to_string(i)));
+            }
+            // the first segment fully and the second one half consumed
+            for (int i = 0; i < 3; ++i) {
+                spool.pop();
+            }
+        }
+        Spool spool(dir, 1 << 20, SEGMENT_BYTES);
+        CHECK(spool.stats().records == 3);
+        CHECK(spool.stats().bytes == 3 * PAYLOAD_BYTES);
+        // the fully consumed segment was removed on recovery
+        CHECK(segment_files(dir) == 2);
+        // appends go behind the recovered records
+        CHECK(spool.append(payload(6), "6"));
+        CHECK(drains_in_order(spool, 3, 6));
+    }
+
+    void corrupted_tail_record() {
+        const auto dir = spool_dir("corrupt");
+        {
+            Spool spool(dir, 1 << 20, 4096);
+            for (int i = 0; i < 3; ++i) {
+                CHECK(spool.append(payload(i), std::to_string(i)));
+            }
+        }
+        // flip a payload byte of the third record, as a write torn by a power loss would leave it
+        const auto segment = std::filesystem::directory_iterator(dir)->path();
+        {
+            std::fstream file(segment, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(2 * 64 + 24 + 3);
+            file.put('X');
+        }
+        Spool spool(dir, 1 << 20, 4096);
+        CHECK(spool.stats().records == 2);
+        CHECK(drains_in_order(spool, 0, 1));
+    }
+
+    void max_bytes_refuses_and_counts() {
+        const auto dir = spool_dir("budget");
+        // two segments fit the budget, a third one does not
+        Spool spool(dir, 2 * SEGMENT_BYTES, SEGMENT_BYTES);
+        for (int i = 0; i < 4; ++i) {
+            CHECK(spool.append(payload(i), std::to_string(i)));
+        }
+        CHECK(!spool.append(payload(4), "4"));
+        CHECK(!spool.append(payload(5), "5"));
+        auto stats = spool.stats();
+        CHECK(stats.dropped == 2);
+        CHECK(stats.records == 4);
+        CHECK(stats.diskBytes == 2 * SEGMENT_BYTES);
+
+        // consuming the first segment gives its bytes back
+        spool.pop();
+        spool.pop();
+        CHECK(spool.stats().diskBytes == SEGMENT_BYTES);
+        CHECK(spool.append(payload(4), "4"));
+        stats = spool.stats();
+        CHECK(stats.dropped == 2 && stats.spooled == 5);
+        CHECK(drains_in_order(spool, 2, 4));
+    }
+
+    void record_larger_than_a_segment() {
+        const auto dir = spool_dir("large");
+        Spool spool(dir, 1 << 20, SEGMENT_BYTES);
+        CHECK(spool.append(payload(0), "0"));
+        const std::string large(1000, 'L');
+        CHECK(spool.append(large, "large"));
+        CHECK(spool.append(payload(1), "1"));
+        // the large record got a segment of its own, sized to fit it
+        CHECK(segment_files(dir) == 3);
+        CHECK(spool.stats().diskBytes >= 2 * SEGMENT_BYTES + 1000);
+
+        auto record = spool.front();
+        CHECK(record.has_value() && record->payload == payload(0));
+        spool.pop();
+        record = spool.front();
+        CHECK(record.has_value() && record->payload == large && record->meta == "large");
+        spool.pop();
+        record = spool.front();
+        CHECK(record.has_value() && record->payload == payload(1));
+        spool.pop();
+        CHECK(spool.empty());
+
+        // a large record over the budget is refused like any other
+        Spool small(spool_dir("large_budget"), 4 * SEGMENT_BYTES, SEGMENT_BYTES);
+        CHECK(!small.append(large));
+        CHECK(small.stats().dropped == 1);
+    }
+}
+
+int main() {
+    order_across_segments();
+    reopen_with_consumed_and_pending();
+    corrupted_tail_record();
+    max_bytes_refuses_and_counts();
+    record_larger_than_a_segment();
+    for (const auto *name : {"order", "reopen", "corrupt", "budget", "large", "large_budget"}) {
+        std::filesystem::remove_all(std::filesystem::temp_directory_path() / (std::string("spool_test_") + name));
+    }
+    return test::exit_code();
+}
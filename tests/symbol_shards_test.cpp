@@ -0,0 +1,42 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// shard_for, the connection QuestDBWriter writes a symbol's rows on: always in range, stable, and
+// dense ids spread evenly.
+
+#include <vector>
+
+#include "common/io/symbol_shards.h"
+#include "check.h"
+
+namespace {
+
+    using common::io::shard_for;
+    using common::models::types::Symbol;
+
+    void stays_in_range(const size_t connections) {
+        for (const Symbol symbol : {Symbol{0}, Symbol{1}, Symbol{61}, Symbol{65'534}, Symbol{65'535}}) {
+            CHECK(shard_for(symbol, connections) < connections);
+            CHECK(shard_for(symbol, connections) == shard_for(symbol, connections));
+        }
+    }
+
+    void spreads_dense_ids_evenly(const size_t connections) {
+        constexpr size_t SYMBOLS = 1'000;
+        std::vector<size_t> per_connection(connections, 0);
+        for (size_t s = 0; s < SYMBOLS; ++s) {
+            ++per_connection[shard_for(static_cast<Symbol>(s), connections)];
+        }
+        for (const size_t count : per_connection) {
+            CHECK(count == SYMBOLS / connections || count == SYMBOLS / connections + 1);
+        }
+    }
+}
+
+int main() {
+    for (const size_t connections : {1, 2, 3, 4, 7}) {
+        stays_in_range(connections);
+        spreads_dense_ids_evenly(connections);
+    }
+    return test::exit_code();
+}
@@ -0,0 +1,210 @@
+//
+// Created by jtwears on 10/17/26.
+//
+// ZipInflateStream over zip entries built in memory: deflate with and without a data descriptor (its
+// signature present or not), stored entries, every feed chunk size down to single bytes, and the
+// errors - crc mismatch, truncated stream, unsupported method - that finish() and feed() report.
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <zlib.h>
+
+#include "common/io/zip_stream.h"
+#include "check.h"
+
+namespace {
+
+    using common::io::ZipInflateStream;
+
+    constexpr uint16_t FLAG_DATA_DESCRIPTOR = 0x0008;
+    constexpr uint16_t METHOD_STORED = 0;
+    constexpr uint16_t METHOD_DEFLATE = 8;
+
+    enum class Descriptor {
+        NONE,
+        WITH_SIGNATURE,
+        WITHOUT_SIGNATURE,
+    };
+
+    struct Entry {
+        uint16_t method = METHOD_DEFLATE;
+        Descriptor descriptor = Descriptor::NONE;
+        // added to the crc written to the archive
+        uint32_t crc_error = 0;
+        std::string extra{};
+    };
+
+    void put_u16(std::string &out, const uint16_t value) {
+        out.push_back(static_cast<char>(value & 0xff));
+        out.push_back(static_cast<char>(value >> 8));
+    }
+
+    void put_u32(std::string &out, const uint32_t value) {
+        put_u16(out, static_cast<uint16_t>(value & 0xffff));
+        put_u16(out, static_cast<uint16_t>(value >> 16));
+    }
+
+    std::string raw_deflate(const std::string_view data) {
+        z_stream zs{};
+        deflateInit2(&zs, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+        std::string out(deflateBound(&zs, static_cast<uLong>(data.size())), '\0');
+        zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+        zs.avail_in = static_cast<uInt>(data.size());
+        zs.next_out = reinterpret_cast<Bytef *>(out.data());
+        zs.avail_out = static_cast<uInt>(out.size());
+        deflate(&zs, Z_FINISH);
+        out.resize(zs.total_out);
+        deflateEnd(&zs);
+        return out;
+    }
+
+    // a single entry archive followed by the start of a central directory, which the stream ignores
+    std::string zip(const std::string_view content, const Entry &entry) {
+        const auto crc = static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef *>(content.data()),
+                                                     static_cast<uInt>(content.size()))) + entry.crc_error;
+        const std::string data = entry.method == METHOD_DEFLATE ? raw_deflate(content) : std::string(content);
+        const bool descriptor = entry.descriptor != Descriptor::NONE;
+        const std::string name = "BTCUSDT-trades-2024-01.csv";
+
+        std::string out;
+        put_u32(out, 0x04034b50);
+        put_u16(out, 20);
+        put_u16(out, descriptor ? FLAG_DATA_DESCRIPTOR : 0);
+        put_u16(out, entry.method);
+        put_u32(out, 0); // modification time and date
+        put_u32(out, descriptor ? 0 : crc);
+        put_u32(out, descriptor ? 0 : static_cast<uint32_t>(data.size()));
+        put_u32(out, descriptor ? 0 : static_cast<uint32_t>(content.size()));
+        put_u16(out, static_cast<uint16_t>(name.size()));
+        put_u16(out, static_cast<uint16_t>(entry.extra.size()));
+        out += name;
+        out += entry.extra;
+        out += data;
+        if (entry.descriptor == Descriptor::WITH_SIGNATURE) {
+            put_u32(out, 0x08074b50);
+        }
+        if (descriptor) {
+            put_u32(out, crc);
+            put_u32(out, static_cast<uint32_t>(data.size()));
+            put_u32(out, static_cast<uint32_t>(content.size()));
+        }
+        put_u32(out, 0x02014b50);
+        out += std::string(42, '\0');
+        return out;
+    }
+
+    std::string csv(const size_t rows) {
+        std::string out = "id,price,qty,quote_qty,time,is_buyer_maker\n";
+        for (size_t i = 0; i < rows; ++i) {
+            out += std::to_string(1'000'000 + i) + ",42000." + std::to_string(i % 100) + ",0.00" + std::to_string(i % 9 + 1)
+                   + ",42.0,1704067200" + std::to_string(100 + i % 900) + (i % 2 == 0 ? ",true\n" : ",false\n");
+        }
+        return out;
+    }
+
+    struct Result {
+        bool fed;
+        bool finished;
+        std::string output;
+        std::string error;
+    };
+
+    // feeds archive in chunks of chunk bytes through an inflater with a small output buffer
+    Result stream_through(const std::string_view archive, const size_t chunk) {
+        Result result{true, false, {}, {}};
+        ZipInflateStream stream([&result](const std::string_view out) { result.output.append(out); }, 1024);
+        for (size_t offset = 0; offset < archive.size() && result.fed; offset += chunk) {
+            result.fed = stream.feed(archive.substr(offset, chunk));
+        }
+        result.finished = stream.finish();
+        result.error = stream.error();
+        return result;
+    }
+
+    bool round_trips(const std::string &content, const Entry &entry) {
+        const auto archive = zip(content, entry);
+        bool ok = true;
+        for (const size_t chunk : {archive.size(), size_t{1}, size_t{2}, size_t{3}, size_t{7}, size_t{29}, size_t{31}, size_t{4096}}) {
+            const auto result = stream_through(archive, chunk);
+            ok &= result.fed && result.finished && result.output == content && result.error.empty();
+        }
+        return ok;
+    }
+
+    void deflate_entries() {
+        const auto content = csv(5'000);
+        CHECK(round_trips(content, {}));
+        CHECK(round_trips(content, {.descriptor = Descriptor::WITH_SIGNATURE}));
+        CHECK(round_trips(content, {.descriptor = Descriptor::WITHOUT_SIGNATURE}));
+        // the extra field sits between the name and the data
+        CHECK(round_trips(content, {.extra = std::string(36, 'e')}));
+        CHECK(round_trips("", {}));
+    }
+
+    void stored_entries() {
+        const auto content = csv(500);
+        CHECK(round_trips(content, {.method = METHOD_STORED}));
+        CHECK(round_trips(content, {.method = METHOD_STORED, .extra = "xy"}));
+        // without sizes up front a stored entry has no end to find
+        const auto result = stream_through(zip(content, {.method = METHOD_STORED, .descriptor = Descriptor::WITH_SIGNATURE}), 64);
+        CHECK(!result.fed && !result.finished);
+        CHECK(result.error == "stored entry without sizes cannot be streamed");
+    }
+
+    void crc_mismatch() {
+        const auto content = csv(1'000);
+        for (const auto descriptor : {Descriptor::NONE, Descriptor::WITH_SIGNATURE, Descriptor::WITHOUT_SIGNATURE}) {
+            const auto result = stream_through(zip(content, {.descriptor = descriptor, .crc_error = 1}), 1);
+            // the mismatch only shows once the whole entry is through
+            CHECK(result.fed && !result.finished);
+            CHECK(result.error == "crc mismatch");
+        }
+        const auto stored = stream_through(zip(content, {.method = METHOD_STORED, .crc_error = 1}), 100);
+        CHECK(!stored.finished && stored.error == "crc mismatch");
+    }
+
+    void truncated_stream() {
+        const auto content = csv(1'000);
+        const auto archive = zip(content, {});
+        // inside the fixed header, inside the name, inside the deflate data
+        for (const size_t cut : {size_t{10}, size_t{40}, archive.size() / 2}) {
+            const auto result = stream_through(std::string_view(archive).substr(0, cut), 7);
+            CHECK(result.fed && !result.finished);
+            CHECK(result.error == "truncated zip stream");
+        }
+        const auto stored = zip(content, {.method = METHOD_STORED});
+        const auto result = stream_through(std::string_view(stored).substr(0, stored.size() / 2), 13);
+        CHECK(!result.finished && result.error == "truncated zip stream");
+
+        // a data descriptor cut short of its crc
+        const auto described = zip(content, {.descriptor = Descriptor::WITH_SIGNATURE});
+        const auto descriptor_start = described.size() - 46 - 16;
+        const auto cut = stream_through(std::string_view(described).substr(0, descriptor_start + 6), 5);
+        CHECK(!cut.finished);
+        CHECK(cut.error == "truncated data descriptor");
+        CHECK(stream_through("", 1).error == "truncated zip stream");
+    }
+
+    void unsupported_method() {
+        auto archive = zip(csv(10), {.method = METHOD_STORED});
+        // bzip2
+        archive[8] = 12;
+        const auto result = stream_through(archive, 1);
+        CHECK(!result.fed && !result.finished);
+        CHECK(result.error == "unsupported compression method 12");
+        CHECK(result.output.empty());
+
+        const auto garbage = stream_through(std::string(64, 'x'), 64);
+        CHECK(!garbage.fed && garbage.error == "missing local file header signature");
+    }
+}
+
+int main() {
+    deflate_entries();
+    stored_entries();
+    crc_mismatch();
+    truncated_stream();
+    unsupported_method();
+    return test::exit_code();
+}